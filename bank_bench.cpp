@@ -0,0 +1,302 @@
+// Benchmark: throughput and latency of the Bank operations behind the API.
+// Seeds a data directory with the requested number of accounts and
+// statement history, then runs login, deposit, debit, transfer,
+// getStatement and getBankStatus at each thread count and prints the
+// results as JSON (ops/sec and p50/p99/p999 latency in nanoseconds).
+//
+//   bank_bench [--accounts N] [--history N] [--ops N] [--login-ops N]
+//              [--threads 1,4,...] [--statement-format csv|binary] [--pin-work-factor N]
+//              [--data DIR]   (a new or empty directory; it is kept afterwards)
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Bank.h"
+#include "JsonWriter.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char* BENCH_PIN = "1234";
+constexpr size_t MAX_SESSIONS = 256;
+
+struct Options {
+    size_t accounts = 1000;
+    size_t history = 100;
+    size_t ops = 2000;
+    size_t loginOps = 100;
+    std::vector<size_t> threads;
+    Banking::StatementFormat format = Banking::StatementFormat::Csv;
+    uint32_t workFactor = Banking::CredentialConfig().workFactor;
+    std::string dataDir;
+};
+
+struct Result {
+    std::string operation;
+    size_t threads = 0;
+    size_t ops = 0;
+    size_t failures = 0;
+    double seconds = 0;
+    std::vector<uint64_t> latencies;    // nanoseconds, sorted
+};
+
+std::string accountNumber(size_t index) {
+    char text[9];
+    std::snprintf(text, sizeof(text), "%08zu", 10000000 + index);
+    return text;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--accounts") {
+            options.accounts = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (arg == "--history") {
+            options.history = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (arg == "--ops") {
+            options.ops = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (arg == "--login-ops") {
+            options.loginOps = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (arg == "--threads") {
+            std::istringstream list(value);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                options.threads.push_back(std::strtoul(item.c_str(), nullptr, 10));
+            }
+        } else if (arg == "--statement-format") {
+            if (value != "csv" && value != "binary") {
+                std::cerr << "--statement-format must be csv or binary\n";
+                return false;
+            }
+            options.format = value == "csv" ? Banking::StatementFormat::Csv : Banking::StatementFormat::Binary;
+        } else if (arg == "--pin-work-factor") {
+            options.workFactor = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--data") {
+            options.dataDir = value;
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (options.accounts < 1 || options.accounts > 1000000) {
+        std::cerr << "--accounts must be between 1 and 1000000\n";
+        return false;
+    }
+    options.history = std::max<size_t>(1, options.history);
+    if (options.threads.empty()) {
+        options.threads = {1, std::max<size_t>(2, std::thread::hardware_concurrency())};
+    }
+    options.threads.erase(std::remove(options.threads.begin(), options.threads.end(), 0), options.threads.end());
+    return !options.threads.empty();
+}
+
+// Write the accounts straight to disk, as the Bank would have left them:
+// a pin file holding a hash and a CSV statement of history lines. Every
+// account shares one hash, so the Bank does not hash a PIN per account at
+// startup; it converts the statements if the binary format was asked for.
+void seedAccounts(const Options& options) {
+    Banking::CredentialConfig config;
+    config.workFactor = options.workFactor;
+    config.verifyThreads = 1;
+    std::string storedHash = Banking::CredentialStore(config).hashPin(BENCH_PIN);
+
+    std::string statement = "2026-01-01 00:00:00,ACCOUNT_CREATED,0.00,0.00\n";
+    for (size_t i = 1; i < options.history; ++i) {
+        char line[64];
+        std::snprintf(line, sizeof(line), "2026-01-01 %02zu:%02zu:%02zu,DEPOSIT,100.00,%zu.00\n",
+                      i / 3600 % 24, i / 60 % 60, i % 60, i * 100);
+        statement += line;
+    }
+
+    for (size_t i = 0; i < options.accounts; ++i) {
+        fs::path accountDir = fs::path(options.dataDir) / "accounts" / accountNumber(i);
+        fs::create_directories(accountDir);
+        std::ofstream(accountDir / "pin.txt") << storedHash;
+        std::ofstream(accountDir / "statement.csv") << statement;
+    }
+}
+
+// Run operation on each of threadCount threads, ops times each, timing every
+// call. operation gets the thread's random generator and returns "ok" or an
+// error; errors are counted but still timed.
+Result run(const std::string& name, size_t threadCount, size_t ops,
+           const std::function<std::string(std::mt19937_64&)>& operation) {
+    std::vector<std::vector<uint64_t>> latencies(threadCount);
+    std::atomic<size_t> failures{0};
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937_64 random(t * 7919 + 1);
+            auto& mine = latencies[t];
+            mine.reserve(ops);
+            ready++;
+            while (!go) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < ops; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                std::string outcome = operation(random);
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                mine.push_back(static_cast<uint64_t>(std::chrono::nanoseconds(elapsed).count()));
+                if (outcome.rfind("error:", 0) == 0 || outcome.empty()) {
+                    failures++;
+                }
+            }
+        });
+    }
+    while (ready < threadCount) {
+        std::this_thread::yield();
+    }
+    auto start = std::chrono::steady_clock::now();
+    go = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Result result;
+    result.operation = name;
+    result.threads = threadCount;
+    result.ops = threadCount * ops;
+    result.failures = failures;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (auto& mine : latencies) {
+        result.latencies.insert(result.latencies.end(), mine.begin(), mine.end());
+    }
+    std::sort(result.latencies.begin(), result.latencies.end());
+    return result;
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double fraction) {
+    if (sorted.empty()) return 0;
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(fraction * static_cast<double>(sorted.size())));
+    return sorted[index];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+    // Only a directory the benchmark made itself is ever removed; --data must
+    // name a new or empty directory, so existing data is never touched
+    bool removeData = options.dataDir.empty();
+    if (removeData) {
+        std::string pattern = (fs::temp_directory_path() / "bank_bench.XXXXXX").string();
+        if (mkdtemp(pattern.data()) == nullptr) {
+            std::cerr << "Cannot create a temporary data directory\n";
+            return 1;
+        }
+        options.dataDir = pattern;
+    } else {
+        std::error_code error;
+        if (fs::exists(options.dataDir, error) && !fs::is_empty(options.dataDir, error)) {
+            std::cerr << "--data " << options.dataDir << " is not empty; give a new or empty directory\n";
+            return 1;
+        }
+        if (error) {
+            std::cerr << "Cannot use --data " << options.dataDir << ": " << error.message() << "\n";
+            return 1;
+        }
+    }
+
+    std::cerr << "Seeding " << options.accounts << " accounts with " << options.history << " transactions each\n";
+    seedAccounts(options);
+
+    Banking::CredentialConfig credentialConfig;
+    credentialConfig.workFactor = options.workFactor;
+    // Let every benchmark thread queue for the verifiers, so login latency is
+    // measured rather than refused
+    credentialConfig.maxPendingVerifications = *std::max_element(options.threads.begin(), options.threads.end());
+    std::vector<Result> results;
+    {
+        Banking::Bank bank(options.dataDir, Banking::SessionConfig(), options.format, Banking::TimestampFormat(),
+                           credentialConfig);
+
+        // A pool of logged-in accounts for the customer operations to spread over
+        std::vector<std::string> sessions;
+        for (size_t i = 0; i < std::min(options.accounts, MAX_SESSIONS); ++i) {
+            sessions.push_back(bank.login(accountNumber(i * options.accounts / std::min(options.accounts, MAX_SESSIONS)),
+                                          BENCH_PIN));
+        }
+        auto anySession = [&](std::mt19937_64& random) -> const std::string& {
+            return sessions[random() % sessions.size()];
+        };
+
+        for (size_t threadCount : options.threads) {
+            std::cerr << "Running with " << threadCount << " thread(s)\n";
+            results.push_back(run("login", threadCount, options.loginOps, [&](std::mt19937_64& random) {
+                std::string sessionId = bank.login(accountNumber(random() % options.accounts), BENCH_PIN);
+                bank.logout(sessionId);
+                return sessionId;
+            }));
+            results.push_back(run("deposit", threadCount, options.ops, [&](std::mt19937_64& random) {
+                return bank.deposit(anySession(random), Banking::Money::fromCents(100));
+            }));
+            results.push_back(run("debit", threadCount, options.ops, [&](std::mt19937_64& random) {
+                return bank.debit(anySession(random), Banking::Money::fromCents(1));
+            }));
+            results.push_back(run("transfer", threadCount, options.ops, [&](std::mt19937_64& random) {
+                const std::string& sessionId = anySession(random);
+                size_t to = random() % options.accounts;
+                if (accountNumber(to) == bank.getAccountFromSession(sessionId)) {
+                    to = (to + 1) % options.accounts;
+                }
+                return bank.transfer(sessionId, accountNumber(to), Banking::Money::fromCents(1));
+            }));
+            results.push_back(run("getStatement", threadCount, options.ops, [&](std::mt19937_64& random) {
+                return bank.getStatement(anySession(random), 10);
+            }));
+            results.push_back(run("getBankStatus", threadCount, options.ops, [&](std::mt19937_64&) {
+                return bank.getBankStatus();
+            }));
+        }
+    }
+    if (removeData) {
+        fs::remove_all(options.dataDir);
+    }
+
+    std::string out;
+    Banking::JsonWriter json(out);
+    json.beginObject()
+        .key("accounts").value(static_cast<uint64_t>(options.accounts))
+        .key("history").value(static_cast<uint64_t>(options.history))
+        .key("format").value(options.format == Banking::StatementFormat::Csv ? "csv" : "binary")
+        .key("pin_work_factor").value(static_cast<uint64_t>(options.workFactor))
+        .key("results").beginArray();
+    for (const auto& result : results) {
+        json.beginObject()
+            .key("operation").value(result.operation)
+            .key("threads").value(static_cast<uint64_t>(result.threads))
+            .key("ops").value(static_cast<uint64_t>(result.ops))
+            .key("failures").value(static_cast<uint64_t>(result.failures))
+            .key("ops_per_sec").value(static_cast<uint64_t>(static_cast<double>(result.ops) / result.seconds))
+            .key("p50_ns").value(percentile(result.latencies, 0.50))
+            .key("p99_ns").value(percentile(result.latencies, 0.99))
+            .key("p999_ns").value(percentile(result.latencies, 0.999))
+            .endObject();
+    }
+    json.endArray().endObject();
+    std::cout << out << "\n";
+    return 0;
+}
@@ -1,10 +1,32 @@
 #include <catch2/catch_test_macros.hpp>
+#include <algorithm>
 #include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <set>
+#include <cstring>
+#include <chrono>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include "AccountIndex.h"
 #include "Bank.h"
+#include "JsonWriter.h"
+#include "MappedFile.h"
+#include "SecureRandom.h"
+#include "StaticAsset.h"
+#include "StatementFile.h"
+#include "WebServer.h"
 
 namespace fs = std::filesystem;
 
 using Banking::Bank;
+using Banking::operator""_money;
 
 // Helper to clean up test data
 class TestFixture {
@@ -26,6 +48,88 @@ public:
     }
 };
 
+// Send each chunk to a local WebServer as a separate write, pausing between
+// them so they arrive as separate reads, then half-close the connection and
+// return everything the server sent back
+std::string httpExchange(int port, const std::vector<std::string>& chunks) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return "";
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    struct timeval timeout = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return "";
+    }
+    
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        if (i > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        send(fd, chunks[i].data(), chunks[i].size(), MSG_NOSIGNAL);
+    }
+    shutdown(fd, SHUT_WR);
+    
+    std::string response;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, static_cast<size_t>(n));
+    }
+    close(fd);
+    return response;
+}
+
+// Open a connection that stays open for several exchanges; -1 on failure.
+// receiveBuffer, if set, shrinks the socket's receive buffer.
+int connectLoopback(int port, int receiveBuffer = 0) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (receiveBuffer > 0) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+    }
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    struct timeval timeout = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Read until the text received ends with suffix; whatever arrived if the
+// peer closes or the receive times out first
+std::string readUntil(int fd, const std::string& suffix) {
+    std::string response;
+    char buffer[4096];
+    while (response.size() < suffix.size() ||
+           response.compare(response.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) break;
+        response.append(buffer, static_cast<size_t>(n));
+    }
+    return response;
+}
+
+size_t countOccurrences(const std::string& text, const std::string& pattern) {
+    size_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+        ++count;
+    }
+    return count;
+}
+
 TEST_CASE("Bank") {
     TestFixture fixture;
     Bank bank(fixture.testDataDir);
@@ -71,7 +175,7 @@ TEST_CASE("Bank") {
         
         std::string customerSession = bank.login("12345678", "1234");
         
-        std::string result = bank.deposit(customerSession, 100.00);
+        std::string result = bank.deposit(customerSession, 100.00_money);
         CHECK(result == "ok");
     }
     
@@ -80,9 +184,9 @@ TEST_CASE("Bank") {
         bank.createAccount(adminSession, "12345678", "1234");
         
         std::string customerSession = bank.login("12345678", "1234");
-        bank.deposit(customerSession, 100.00);
+        bank.deposit(customerSession, 100.00_money);
         
-        std::string result = bank.debit(customerSession, 50.00);
+        std::string result = bank.debit(customerSession, 50.00_money);
         CHECK(result == "ok");
     }
     
@@ -91,9 +195,9 @@ TEST_CASE("Bank") {
         bank.createAccount(adminSession, "12345678", "1234");
         
         std::string customerSession = bank.login("12345678", "1234");
-        bank.deposit(customerSession, 100.00);
+        bank.deposit(customerSession, 100.00_money);
         
-        std::string result = bank.debit(customerSession, 200.00);
+        std::string result = bank.debit(customerSession, 200.00_money);
         CHECK(result == "error: insufficient funds");
     }
     
@@ -102,8 +206,8 @@ TEST_CASE("Bank") {
         bank.createAccount(adminSession, "12345678", "1234");
         
         std::string customerSession = bank.login("12345678", "1234");
-        bank.deposit(customerSession, 100.00);
-        bank.debit(customerSession, 30.00);
+        bank.deposit(customerSession, 100.00_money);
+        bank.debit(customerSession, 30.00_money);
         
         std::string statement = bank.getStatement(customerSession, 10);
         CHECK(statement.find("DEPOSIT") != std::string::npos);
@@ -125,10 +229,10 @@ TEST_CASE("Bank") {
         bank.createAccount(adminSession, "87654321", "4321");
         
         std::string customer1Session = bank.login("12345678", "1234");
-        bank.deposit(customer1Session, 100.00);
+        bank.deposit(customer1Session, 100.00_money);
         
         std::string customer2Session = bank.login("87654321", "4321");
-        bank.deposit(customer2Session, 200.00);
+        bank.deposit(customer2Session, 200.00_money);
         
         std::string report = bank.listAccounts(adminSession);
         CHECK(report.find("Total Accounts: 2") != std::string::npos);
@@ -140,7 +244,7 @@ TEST_CASE("Bank") {
         bank.createAccount(adminSession, "12345678", "1234");
         
         std::string customerSession = bank.login("12345678", "1234");
-        bank.deposit(customerSession, 500.00);
+        bank.deposit(customerSession, 500.00_money);
         
         std::string statement = bank.getStatement(adminSession, 10);
         CHECK(statement.find("Bank Status Report") != std::string::npos);
@@ -188,9 +292,9 @@ TEST_CASE("Bank") {
         bank.createAccount(adminSession, "87654321", "4321");
         
         std::string customer1Session = bank.login("12345678", "1234");
-        bank.deposit(customer1Session, 500.00);
+        bank.deposit(customer1Session, 500.00_money);
         
-        std::string result = bank.transfer(customer1Session, "87654321", 200.00);
+        std::string result = bank.transfer(customer1Session, "87654321", 200.00_money);
         CHECK(result == "ok");
         
         // Check statements show transfer
@@ -208,9 +312,9 @@ TEST_CASE("Bank") {
         bank.createAccount(adminSession, "87654321", "4321");
         
         std::string customerSession = bank.login("12345678", "1234");
-        bank.deposit(customerSession, 100.00);
+        bank.deposit(customerSession, 100.00_money);
         
-        std::string result = bank.transfer(customerSession, "87654321", 200.00);
+        std::string result = bank.transfer(customerSession, "87654321", 200.00_money);
         CHECK(result == "error: insufficient funds");
     }
     
@@ -219,9 +323,9 @@ TEST_CASE("Bank") {
         bank.createAccount(adminSession, "12345678", "1234");
         
         std::string customerSession = bank.login("12345678", "1234");
-        bank.deposit(customerSession, 100.00);
+        bank.deposit(customerSession, 100.00_money);
         
-        std::string result = bank.transfer(customerSession, "99999999", 50.00);
+        std::string result = bank.transfer(customerSession, "99999999", 50.00_money);
         CHECK(result == "error: destination account does not exist");
     }
     
@@ -230,9 +334,9 @@ TEST_CASE("Bank") {
         bank.createAccount(adminSession, "12345678", "1234");
         
         std::string customerSession = bank.login("12345678", "1234");
-        bank.deposit(customerSession, 100.00);
+        bank.deposit(customerSession, 100.00_money);
         
-        std::string result = bank.transfer(customerSession, "12345678", 50.00);
+        std::string result = bank.transfer(customerSession, "12345678", 50.00_money);
         CHECK(result == "error: cannot transfer to same account");
     }
     
@@ -242,9 +346,1412 @@ TEST_CASE("Bank") {
         bank.createAccount(adminSession, "87654321", "4321");
         
         std::string customerSession = bank.login("12345678", "1234");
-        bank.deposit(customerSession, 100.00);
+        bank.deposit(customerSession, 100.00_money);
         
-        std::string result = bank.transfer(customerSession, "87654321", -50.00);
+        std::string result = bank.transfer(customerSession, "87654321", -50.00_money);
         CHECK(result == "error: amount must be positive");
     }
+    
+    SECTION("Balance is recovered from statement after restart") {
+        std::string adminSession = bank.login("00000000", "9999");
+        bank.createAccount(adminSession, "12345678", "1234");
+        
+        std::string customerSession = bank.login("12345678", "1234");
+        bank.deposit(customerSession, 100.00_money);
+        bank.debit(customerSession, 25.50_money);
+        
+        Bank reopened(fixture.testDataDir);
+        std::string reopenedSession = reopened.login("12345678", "1234");
+        CHECK(reopened.debit(reopenedSession, 74.51_money) == "error: insufficient funds");
+        CHECK(reopened.debit(reopenedSession, 74.50_money) == "ok");
+    }
+    
+    SECTION("A damaged statement tail keeps the last valid balance") {
+        std::string dataDir = fixture.testDataDir + "/damaged";
+        {
+            Bank scoped(dataDir);
+            std::string adminSession = scoped.login("00000000", "9999");
+            REQUIRE(scoped.createAccount(adminSession, "12345678", "1234") == "ok");
+            REQUIRE(scoped.createAccount(adminSession, "87654321", "4321") == "ok");
+            REQUIRE(scoped.deposit(scoped.login("12345678", "1234"), 100.00_money) == "ok");
+            REQUIRE(scoped.deposit(scoped.login("87654321", "4321"), 20.00_money) == "ok");
+        }
+        {
+            std::ofstream statement(dataDir + "/accounts/12345678/statement.csv", std::ios::app);
+            statement << "\n2026-01-09 10:00:00,DEPOSIT,oops\n\n";
+        }
+        
+        Bank reopened(dataDir);
+        std::string report = reopened.listAccounts(reopened.login("00000000", "9999"));
+        CHECK(report.find("Account 12345678: 100.00") != std::string::npos);
+        CHECK(report.find("Total Holdings: 120.00") != std::string::npos);
+        std::string session = reopened.login("12345678", "1234");
+        CHECK(reopened.debit(session, 100.01_money) == "error: insufficient funds");
+        CHECK(reopened.debit(session, 100.00_money) == "ok");
+    }
+    
+    SECTION("Statements are rebuilt from the journal after a crash") {
+        std::string adminSession = bank.login("00000000", "9999");
+        bank.createAccount(adminSession, "12345678", "1234");
+        
+        std::string customerSession = bank.login("12345678", "1234");
+        bank.deposit(customerSession, 100.00_money);
+        bank.deposit(customerSession, 50.00_money);
+        
+        // Simulate a crash after the journal commit but before the statement
+        // view caught up: drop the last statement line and the checkpoint
+        std::string statementPath = fixture.testDataDir + "/accounts/12345678/statement.csv";
+        fs::resize_file(statementPath, fs::file_size(statementPath) - 10);
+        fs::remove(fixture.testDataDir + "/journal.checkpoint");
+        
+        Bank reopened(fixture.testDataDir);
+        std::string reopenedSession = reopened.login("12345678", "1234");
+        std::string statement = reopened.getStatement(reopenedSession, 10);
+        CHECK(statement.find("ACCOUNT_CREATED") == statement.rfind("ACCOUNT_CREATED"));
+        CHECK(statement.find("100.00,100.00") != std::string::npos);
+        CHECK(statement.find("50.00,150.00") != std::string::npos);
+        CHECK(reopened.debit(reopenedSession, 150.01_money) == "error: insufficient funds");
+    }
+    
+    SECTION("Checkpoint is written durably and catches up at shutdown") {
+        std::string dataDir = fixture.testDataDir + "/checkpointed";
+        {
+            Bank scoped(dataDir);
+            std::string adminSession = scoped.login("00000000", "9999");
+            REQUIRE(scoped.createAccount(adminSession, "12345678", "1234") == "ok");
+            std::string customerSession = scoped.login("12345678", "1234");
+            REQUIRE(scoped.deposit(customerSession, 100.00_money) == "ok");
+            REQUIRE(scoped.deposit(customerSession, 50.00_money) == "ok");
+        }
+        
+        // Stopping the journal syncs the statements and checkpoints them all
+        uint64_t checkpoint = 0;
+        std::ifstream(dataDir + "/journal.checkpoint") >> checkpoint;
+        CHECK(checkpoint == 3);
+        CHECK(!fs::exists(dataDir + "/journal.checkpoint.tmp"));
+        
+        // A stale checkpoint replays records the statements already hold
+        // without duplicating them
+        {
+            std::ofstream(dataDir + "/journal.checkpoint", std::ios::trunc) << 1 << "\n";
+        }
+        Bank reopened(dataDir);
+        std::string session = reopened.login("12345678", "1234");
+        std::string statement = reopened.getStatement(session, 10);
+        CHECK(statement.find("100.00,100.00") == statement.rfind("100.00,100.00"));
+        CHECK(statement.find("50.00,150.00") == statement.rfind("50.00,150.00"));
+        CHECK(reopened.debit(session, 150.01_money) == "error: insufficient funds");
+    }
+    
+    SECTION("A failed journal write changes nothing and stops the bank") {
+        // Writes to /dev/full fail with ENOSPC, like a full disk
+        if (fs::exists("/dev/full")) {
+            std::string dataDir = fixture.testDataDir + "/failing";
+            {
+                Bank setup(dataDir);
+                std::string adminSession = setup.login("00000000", "9999");
+                REQUIRE(setup.createAccount(adminSession, "12345678", "1234") == "ok");
+                REQUIRE(setup.createAccount(adminSession, "87654321", "4321") == "ok");
+                REQUIRE(setup.deposit(setup.login("12345678", "1234"), 100.00_money) == "ok");
+            }
+            
+            fs::remove(dataDir + "/journal.log");
+            fs::create_symlink("/dev/full", dataDir + "/journal.log");
+            {
+                Bank failing(dataDir);
+                std::string adminSession = failing.login("00000000", "9999");
+                std::string session = failing.login("12345678", "1234");
+                REQUIRE(!session.empty());
+                CHECK(failing.transfer(session, "87654321", 60.00_money) == "error: transaction could not be recorded");
+                
+                // Nothing else is served once the journal has failed
+                const std::string refused = "error: bank unavailable, transactions cannot be recorded";
+                CHECK(failing.debit(session, 60.00_money) == refused);
+                CHECK(failing.deposit(session, 1.00_money) == refused);
+                CHECK(failing.transfer(session, "87654321", 1.00_money) == refused);
+                std::vector<std::string> results;
+                CHECK(failing.applyBatch(session, {{Banking::TransactionType::DEBIT, 1.00_money, ""}}, results) == refused);
+                CHECK(failing.getStatement(session) == refused);
+                std::vector<Banking::Transaction> page;
+                uint64_t next = 0;
+                CHECK(failing.getTransactions(session, page, next) == refused);
+                CHECK(failing.getBankStatus() == refused);
+                CHECK(failing.listAccounts(adminSession) == refused);
+                CHECK(failing.createAccount(adminSession, "11111111", "1111") == refused);
+                CHECK(failing.login("87654321", "4321").empty());
+            }
+            
+            // The failed transfer left no trace
+            fs::remove(dataDir + "/journal.log");
+            Bank reopened(dataDir);
+            std::string adminSession = reopened.login("00000000", "9999");
+            std::string report = reopened.listAccounts(adminSession);
+            CHECK(report.find("Account 12345678: 100.00") != std::string::npos);
+            CHECK(report.find("Account 87654321: 0.00") != std::string::npos);
+            CHECK(report.find("Total Holdings: 100.00") != std::string::npos);
+        }
+    }
+    
+    SECTION("The journal is compacted behind the checkpoint and sequences carry on") {
+        std::string dataDir = fixture.testDataDir + "/compacted";
+        uint64_t checkpoint = 0;
+        {
+            Bank scoped(dataDir);
+            std::string adminSession = scoped.login("00000000", "9999");
+            REQUIRE(scoped.createAccount(adminSession, "12345678", "1234") == "ok");
+            std::string customerSession = scoped.login("12345678", "1234");
+            std::vector<Banking::BatchOperation> deposits(Banking::MAX_BATCH_OPERATIONS,
+                                                         {Banking::TransactionType::DEPOSIT, 0.01_money, ""});
+            std::vector<std::string> results;
+            while (fs::file_size(dataDir + "/journal.log") <= static_cast<uintmax_t>(Banking::Journal::COMPACT_BYTES)) {
+                REQUIRE(scoped.applyBatch(customerSession, deposits, results) == "ok");
+            }
+        }
+        
+        // Shutdown checkpointed every record, so the log started over
+        std::ifstream(dataDir + "/journal.checkpoint") >> checkpoint;
+        CHECK(checkpoint > Banking::MAX_BATCH_OPERATIONS);
+        CHECK(fs::file_size(dataDir + "/journal.log") == 0);
+        
+        // New records are numbered after the checkpoint, not from 1, so a
+        // replay after a crash does not take them for applied ones
+        {
+            Bank reopened(dataDir);
+            std::string session = reopened.login("12345678", "1234");
+            REQUIRE(reopened.deposit(session, 1.00_money) == "ok");
+            std::ifstream journalFile(dataDir + "/journal.log");
+            std::string record;
+            std::getline(journalFile, record);
+            CHECK(record.rfind(std::to_string(checkpoint + 1) + ",12345678,", 0) == 0);
+        }
+        uint64_t reopenedCheckpoint = 0;
+        std::ifstream(dataDir + "/journal.checkpoint") >> reopenedCheckpoint;
+        CHECK(reopenedCheckpoint == checkpoint + 1);
+    }
+    
+    SECTION("A batch that fails to reach the journal is cut back out of it") {
+        std::string dataDir = fixture.testDataDir + "/rejected";
+        {
+            Bank setup(dataDir);
+            std::string adminSession = setup.login("00000000", "9999");
+            REQUIRE(setup.createAccount(adminSession, "12345678", "1234") == "ok");
+            REQUIRE(setup.deposit(setup.login("12345678", "1234"), 100.00_money) == "ok");
+        }
+        
+        // A file size limit a few bytes past the log makes the next write
+        // land only partly, as a failing disk might
+        struct rlimit original;
+        REQUIRE(getrlimit(RLIMIT_FSIZE, &original) == 0);
+        auto previousHandler = signal(SIGXFSZ, SIG_IGN);
+        {
+            Bank failing(dataDir);
+            std::string session = failing.login("12345678", "1234");
+            uintmax_t logSize = fs::file_size(dataDir + "/journal.log");
+            struct rlimit limited = original;
+            limited.rlim_cur = static_cast<rlim_t>(logSize + 10);
+            REQUIRE(setrlimit(RLIMIT_FSIZE, &limited) == 0);
+            CHECK(failing.deposit(session, 5.00_money) == "error: transaction could not be recorded");
+            setrlimit(RLIMIT_FSIZE, &original);
+            CHECK(fs::file_size(dataDir + "/journal.log") <= logSize);
+        }
+        signal(SIGXFSZ, previousHandler);
+        
+        {
+            Bank reopened(dataDir);
+            std::string session = reopened.login("12345678", "1234");
+            CHECK(reopened.getStatement(session, 10).find("5.00") == std::string::npos);
+            CHECK(reopened.debit(session, 100.01_money) == "error: insufficient funds");
+        }
+        
+        // A log whose rejected batch could not be removed keeps the bank
+        // from serving anything until the marker is cleared
+        std::ofstream(dataDir + "/journal.log.failed") << "sequences 4 to 4 were rejected\n";
+        {
+            Bank blocked(dataDir);
+            CHECK(blocked.login("12345678", "1234").empty());
+            CHECK(blocked.getBankStatus() == "error: bank unavailable, transactions cannot be recorded");
+        }
+        fs::remove(dataDir + "/journal.log.failed");
+        Bank cleared(dataDir);
+        CHECK_FALSE(cleared.login("12345678", "1234").empty());
+    }
+    
+    SECTION("Concurrent transfers never overdraw and conserve holdings") {
+        std::string adminSession = bank.login("00000000", "9999");
+        std::vector<std::string> accounts = {"11111111", "22222222", "33333333"};
+        std::vector<std::string> sessions;
+        for (const auto& account : accounts) {
+            bank.createAccount(adminSession, account, "1234");
+            sessions.push_back(bank.login(account, "1234"));
+            bank.deposit(sessions.back(), 100.00_money);
+        }
+        
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 6; ++t) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < 30; ++i) {
+                    size_t from = (t + i) % accounts.size();
+                    size_t to = (from + 1 + t % 2) % accounts.size();
+                    bank.transfer(sessions[from], accounts[to], 45.00_money);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        std::string report = bank.listAccounts(adminSession);
+        CHECK(report.find("Total Holdings: 300.00") != std::string::npos);
+        CHECK(report.find(": -") == std::string::npos);
+    }
+    
+    SECTION("Incomplete journal transaction is discarded on restart") {
+        std::string adminSession = bank.login("00000000", "9999");
+        bank.createAccount(adminSession, "12345678", "1234");
+        bank.createAccount(adminSession, "87654321", "4321");
+        
+        std::string customerSession = bank.login("12345678", "1234");
+        bank.deposit(customerSession, 100.00_money);
+        
+        // First leg of a transfer whose second leg never reached the disk
+        {
+            std::ofstream journalFile(fixture.testDataDir + "/journal.log", std::ios::app);
+            journalFile << "99+,12345678,2026-01-09 10:00:00,TRANSFER_OUT,60.00,40.00\n";
+            journalFile << "100,87654321,2026-01-09 10:00:00,TRANS";
+        }
+        fs::remove(fixture.testDataDir + "/journal.checkpoint");
+        
+        Bank reopened(fixture.testDataDir);
+        std::string reopenedSession = reopened.login("12345678", "1234");
+        CHECK(reopened.getStatement(reopenedSession, 10).find("TRANSFER_OUT") == std::string::npos);
+        CHECK(reopened.debit(reopenedSession, 100.00_money) == "ok");
+    }
+    
+    SECTION("Sessions survive restart only in snapshot mode") {
+        std::string adminSession = bank.login("00000000", "9999");
+        
+        {
+            Bank reopened(fixture.testDataDir);
+            CHECK(reopened.getAccountFromSession(adminSession).empty());
+        }
+        
+        Banking::SessionConfig config;
+        config.persistSnapshot = true;
+        std::string persistentSession;
+        {
+            Bank persistent(fixture.testDataDir, config);
+            persistentSession = persistent.login("00000000", "9999");
+        }
+        Bank restarted(fixture.testDataDir, config);
+        CHECK(restarted.isAdmin(persistentSession));
+    }
+    
+    SECTION("Session store is bounded and expires idle sessions") {
+        auto counter = [](const std::string& report, const std::string& name) {
+            size_t pos = report.find(name + ": ");
+            REQUIRE(pos != std::string::npos);
+            return std::stoul(report.substr(pos + name.size() + 2));
+        };
+        
+        Banking::SessionConfig config;
+        config.maxSessions = 16;
+        config.idleTtl = std::chrono::seconds(1);
+        // Cheap PIN hashing, so 200 logins take well under the idle timeout
+        Banking::CredentialConfig credentialConfig;
+        credentialConfig.workFactor = 1;
+        Bank bounded(fixture.testDataDir, config, Banking::StatementFormat::Csv, Banking::TimestampFormat(),
+                     credentialConfig);
+        std::string adminSession = bounded.login("00000000", "9999");
+        bounded.createAccount(adminSession, "12345678", "1234");
+        
+        for (int i = 0; i < 200; ++i) {
+            REQUIRE_FALSE(bounded.login("12345678", "1234").empty());
+        }
+        adminSession = bounded.login("00000000", "9999");
+        std::string stats = bounded.getSessionStats(adminSession);
+        CHECK(counter(stats, "Live") <= 16);
+        CHECK(counter(stats, "Created") == 202);
+        CHECK(counter(stats, "Live") + counter(stats, "Evicted") == 202);
+        
+        std::string customerSession = bounded.login("12345678", "1234");
+        CHECK(bounded.getSessionStats(customerSession) == "error: unauthorized");
+        
+        std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+        CHECK(bounded.getAccountFromSession(customerSession).empty());
+        CHECK(bounded.getAccountFromSession(adminSession).empty());
+    }
+    
+    SECTION("Account listing is paginated and totals are kept current") {
+        std::string adminSession = bank.login("00000000", "9999");
+        for (int i = 1; i <= 5; ++i) {
+            std::string accountNumber = "1000000" + std::to_string(i);
+            bank.createAccount(adminSession, accountNumber, "1234");
+            bank.deposit(bank.login(accountNumber, "1234"), Banking::Money::fromCents(i * 1000));
+        }
+        std::string customerSession = bank.login("10000001", "1234");
+        bank.transfer(customerSession, "10000002", 5.00_money);
+        bank.debit(customerSession, 1.25_money);
+        
+        std::string status = bank.getBankStatus();
+        CHECK(status.find("Total Accounts: 5") != std::string::npos);
+        CHECK(status.find("Total Holdings: 148.75") != std::string::npos);
+        
+        std::string firstPage = bank.listAccounts(adminSession, "", 2);
+        CHECK(firstPage.find("Account 10000001: 3.75") != std::string::npos);
+        CHECK(firstPage.find("Account 10000002: 25.00") != std::string::npos);
+        CHECK(firstPage.find("Account 10000003") == std::string::npos);
+        CHECK(firstPage.find("Next: 10000002") != std::string::npos);
+        
+        std::string lastPage = bank.listAccounts(adminSession, "10000004", 2);
+        CHECK(lastPage.find("Account 10000005: 50.00") != std::string::npos);
+        CHECK(lastPage.find("Next:") == std::string::npos);
+        CHECK(lastPage.find("Total Holdings: 148.75") != std::string::npos);
+        
+        CHECK(bank.listAccounts(customerSession) == "error: unauthorized");
+        CHECK(bank.listAccounts(adminSession, "", 0) == "error: limit must be positive");
+    }
+    
+    SECTION("An account page never holds more than MAX_ACCOUNTS_PAGE_SIZE accounts") {
+        Banking::CredentialConfig cheapHashes;
+        cheapHashes.workFactor = 1;
+        Bank many(fixture.testDataDir, Banking::SessionConfig(), Banking::StatementFormat::Csv,
+                  Banking::TimestampFormat(), cheapHashes);
+        std::string adminSession = many.login("00000000", "9999");
+        for (size_t i = 1; i <= Banking::MAX_ACCOUNTS_PAGE_SIZE + 10; ++i) {
+            REQUIRE(many.createAccount(adminSession, std::to_string(20000000 + i), "1234").rfind("error", 0) != 0);
+        }
+        
+        std::string page = many.listAccounts(adminSession, "", SIZE_MAX);
+        CHECK(countOccurrences(page, "Account 2") == Banking::MAX_ACCOUNTS_PAGE_SIZE);
+        CHECK(page.find("Next: " + std::to_string(20000000 + Banking::MAX_ACCOUNTS_PAGE_SIZE) + "\n") != std::string::npos);
+        std::string rest = many.listAccounts(adminSession, std::to_string(20000000 + Banking::MAX_ACCOUNTS_PAGE_SIZE),
+                                             Banking::MAX_ACCOUNTS_PAGE_SIZE + 1);
+        CHECK(countOccurrences(rest, "Account 2") == 10);
+        CHECK(rest.find("Next:") == std::string::npos);
+    }
+    
+    SECTION("Binary statements keep balances and convert to and from CSV") {
+        std::string adminSession = bank.login("00000000", "9999");
+        bank.createAccount(adminSession, "12345678", "1234");
+        bank.deposit(bank.login("12345678", "1234"), 100.00_money);
+        std::string csvStatement = bank.getStatement(bank.login("12345678", "1234"), 10);
+        
+        std::string accountDir = fixture.testDataDir + "/accounts/12345678";
+        std::string binaryStatement;
+        {
+            Bank binary(fixture.testDataDir, Banking::SessionConfig(), Banking::StatementFormat::Binary);
+            CHECK(fs::exists(accountDir + "/statement.bin"));
+            CHECK_FALSE(fs::exists(accountDir + "/statement.csv"));
+            
+            std::string session = binary.login("12345678", "1234");
+            CHECK(binary.getStatement(session, 10) == csvStatement);
+            CHECK(binary.deposit(session, 25.50_money) == "ok");
+            CHECK(binary.debit(session, 0.25_money) == "ok");
+            
+            std::string tail = binary.getStatement(session, 2);
+            CHECK(tail.find("DEPOSIT,25.50,125.50\n") != std::string::npos);
+            CHECK(tail.find("DEBIT,0.25,125.25\n") != std::string::npos);
+            CHECK(tail.find("DEPOSIT,100.00") == std::string::npos);
+            CHECK(fs::file_size(accountDir + "/statement.bin") == 4 * sizeof(Banking::StatementRecord));
+            binaryStatement = binary.getStatement(session, 10);
+        }
+        
+        Bank reopened(fixture.testDataDir, Banking::SessionConfig(), Banking::StatementFormat::Binary);
+        std::string session = reopened.login("12345678", "1234");
+        CHECK(reopened.getStatement(session, 10) == binaryStatement);
+        CHECK(reopened.debit(session, 125.26_money) == "error: insufficient funds");
+        
+        Bank exported(fixture.testDataDir);
+        CHECK(fs::exists(accountDir + "/statement.csv"));
+        CHECK_FALSE(fs::exists(accountDir + "/statement.bin"));
+        CHECK(exported.getStatement(exported.login("12345678", "1234"), 10) == binaryStatement);
+    }
+    
+    SECTION("Statement tail reads exactly the last lines of a long CSV") {
+        fs::create_directories(fixture.testDataDir);
+        std::string path = fixture.testDataDir + "/long.csv";
+        {
+            std::ofstream file(path);
+            for (int i = 0; i < 5000; ++i) {
+                file << "2026-01-01 00:00:00,DEPOSIT,1.00," << i << ".00\n";
+            }
+        }
+        Banking::StatementFile statement(path, Banking::StatementFormat::Csv);
+        
+        std::vector<std::string> last = statement.tail(3);
+        REQUIRE(last.size() == 3);
+        CHECK(last[0] == "2026-01-01 00:00:00,DEPOSIT,1.00,4997.00");
+        CHECK(last[2] == "2026-01-01 00:00:00,DEPOSIT,1.00,4999.00");
+        CHECK(statement.tail(1000).front() == "2026-01-01 00:00:00,DEPOSIT,1.00,4000.00");
+        CHECK(statement.tail(10000).size() == 5000);
+        CHECK(statement.lastBalance() == 4999.00_money);
+        
+        // A partial last line is returned as written
+        {
+            std::ofstream file(path, std::ios::app);
+            file << "2026-01-01 00:00:00,DEP";
+        }
+        last = statement.tail(2);
+        REQUIRE(last.size() == 2);
+        CHECK(last[0] == "2026-01-01 00:00:00,DEPOSIT,1.00,4999.00");
+        CHECK(last[1] == "2026-01-01 00:00:00,DEP");
+    }
+    
+    SECTION("Money parses and formats exact cents") {
+        using Banking::Money;
+        Money amount;
+        CHECK(Money::parse("12.5", amount));
+        CHECK(amount.cents() == 1250);
+        CHECK(Money::parse("-0.07", amount));
+        CHECK(amount.toString() == "-0.07");
+        CHECK(Money::parse("1234567", amount));
+        CHECK(amount.toString() == "1234567.00");
+        CHECK(Money::fromCents(5).toString() == "0.05");
+        CHECK(Money::fromCents(INT64_MIN).toString() == "-92233720368547758.08");
+        CHECK_FALSE(Money::parse("", amount));
+        CHECK_FALSE(Money::parse(".", amount));
+        CHECK_FALSE(Money::parse("1.", amount));
+        CHECK_FALSE(Money::parse("1.234", amount));
+        CHECK_FALSE(Money::parse("1e3", amount));
+        CHECK_FALSE(Money::parse(" 1", amount));
+        CHECK_FALSE(Money::parse("99999999999999999", amount));
+        
+        // Balances stay exact where doubles would drift
+        std::string adminSession = bank.login("00000000", "9999");
+        bank.createAccount(adminSession, "12345678", "1234");
+        std::string customerSession = bank.login("12345678", "1234");
+        for (int i = 0; i < 1000; ++i) {
+            bank.deposit(customerSession, 0.10_money);
+        }
+        CHECK(bank.debit(customerSession, 100.01_money) == "error: insufficient funds");
+        CHECK(bank.debit(customerSession, 100.00_money) == "ok");
+    }
+    
+    SECTION("Balances are capped at MAX_BALANCE without overflowing") {
+        using Banking::Money;
+        using Banking::MAX_BALANCE;
+        Money result = 1.00_money;
+        CHECK_FALSE(Money::add(Money::fromCents(INT64_MAX), Money::fromCents(1), result));
+        CHECK_FALSE(Money::subtract(Money::fromCents(INT64_MIN), Money::fromCents(1), result));
+        CHECK(result == 1.00_money);
+        CHECK(Money::add(Money::fromCents(INT64_MAX - 1), Money::fromCents(1), result));
+        CHECK(result.cents() == INT64_MAX);
+        CHECK(Money::subtract(2.50_money, 3.00_money, result));
+        CHECK(result == Money::fromCents(-50));
+        
+        std::string adminSession = bank.login("00000000", "9999");
+        bank.createAccount(adminSession, "12345678", "1234");
+        bank.createAccount(adminSession, "87654321", "4321");
+        std::string fullSession = bank.login("12345678", "1234");
+        std::string otherSession = bank.login("87654321", "4321");
+        
+        // The largest amount that parses cannot be deposited, even repeatedly
+        Money huge;
+        REQUIRE(Money::parse("9999999999999999.99", huge));
+        for (int i = 0; i < 11; ++i) {
+            CHECK(bank.deposit(fullSession, huge) == "error: balance limit exceeded");
+        }
+        
+        CHECK(bank.deposit(fullSession, MAX_BALANCE - 1.00_money) == "ok");
+        CHECK(bank.deposit(fullSession, 1.00_money) == "ok");
+        CHECK(bank.deposit(fullSession, 0.01_money) == "error: balance limit exceeded");
+        
+        // Transfers and batch legs into a full account are refused and change nothing
+        CHECK(bank.deposit(otherSession, 5.00_money) == "ok");
+        CHECK(bank.transfer(otherSession, "12345678", 0.01_money) == "error: balance limit exceeded");
+        std::vector<std::string> results;
+        CHECK(bank.applyBatch(otherSession, {{Banking::TransactionType::TRANSFER_OUT, 1.00_money, "12345678"},
+                                             {Banking::TransactionType::DEBIT, 1.00_money, ""}}, results) == "ok");
+        REQUIRE(results.size() == 2);
+        CHECK(results[0] == "error: balance limit exceeded");
+        CHECK(results[1] == "ok");
+        CHECK(bank.applyBatch(fullSession, {{Banking::TransactionType::DEPOSIT, 0.01_money, ""}}, results) == "ok");
+        CHECK(results[0] == "error: balance limit exceeded");
+        
+        std::string report = bank.listAccounts(adminSession);
+        CHECK(report.find("Account 12345678: 100000000.00") != std::string::npos);
+        CHECK(report.find("Account 87654321: 4.00") != std::string::npos);
+        CHECK(report.find("Total Holdings: 100000004.00") != std::string::npos);
+        
+        // Spending from a full account works, and so does filling it again
+        CHECK(bank.transfer(fullSession, "87654321", 10.00_money) == "ok");
+        CHECK(bank.deposit(fullSession, 10.00_money) == "ok");
+        std::vector<Banking::Transaction> page;
+        uint64_t next = 0;
+        CHECK(bank.getTransactions(fullSession, page, next) == "ok");
+        CHECK(page.back().balance == MAX_BALANCE);
+    }
+    
+    SECTION("Timestamps support local, millisecond and UTC ISO-8601 formats") {
+        Banking::TimestampValue value;
+        REQUIRE(Banking::parseTimestamp("2026-03-01T23:59:58.042Z", value));
+        CHECK(value.seconds == 1772409598);
+        CHECK(value.milliseconds == 42);
+        CHECK(value.format.utc);
+        CHECK(value.format.milliseconds);
+        
+        std::string text;
+        Banking::appendTimestamp(text, value);
+        CHECK(text == "2026-03-01T23:59:58.042Z");
+        
+        CHECK_FALSE(Banking::parseTimestamp("2026-03-01T23:59:58", value));
+        CHECK_FALSE(Banking::parseTimestamp("2026-03-01 23:59:58Z", value));
+        CHECK_FALSE(Banking::parseTimestamp("2026-03-01 23:59:58.4", value));
+        
+        Banking::TimestampFormat format;
+        format.utc = true;
+        format.milliseconds = true;
+        Bank audited(fixture.testDataDir, Banking::SessionConfig(), Banking::StatementFormat::Binary, format);
+        std::string adminSession = audited.login("00000000", "9999");
+        audited.createAccount(adminSession, "12345678", "1234");
+        std::string customerSession = audited.login("12345678", "1234");
+        audited.deposit(customerSession, 10.00_money);
+        
+        // Binary records keep the format each timestamp was written in
+        std::string statement = audited.getStatement(customerSession, 1);
+        std::string line = statement.substr(statement.find('\n') + 1);
+        REQUIRE(line.size() > 24);
+        CHECK(line[10] == 'T');
+        CHECK(line[19] == '.');
+        CHECK(line.substr(23, 15) == "Z,DEPOSIT,10.00");
+        
+        // The format check used when paging agrees with the full parse
+        for (const char* text : {"2026-01-09 10:30:00", "2026-01-09 10:30:00.123", "2026-01-09T10:30:00Z",
+                                 "2026-01-09T10:30:00.123Z"}) {
+            Banking::TimestampValue value;
+            CHECK(Banking::isTimestamp(text));
+            CHECK(Banking::parseTimestamp(text, value));
+        }
+        for (const char* text : {"", "2026-01-09", "2026-01-09 10:30:00Z", "2026-01-09T10:30:00", "2026-01-09 10:30:0x",
+                                 "2026-01-09 10:30:00.12", "2026/01/09 10:30:00"}) {
+            CHECK_FALSE(Banking::isTimestamp(text));
+        }
+    }
+    
+    SECTION("Mapped statement reads follow appends") {
+        std::string adminSession = bank.login("00000000", "9999");
+        bank.createAccount(adminSession, "12345678", "1234");
+        std::string customerSession = bank.login("12345678", "1234");
+        
+        std::string before = bank.getStatement(customerSession, 10);
+        CHECK(before.find("DEPOSIT") == std::string::npos);
+        for (int i = 1; i <= 3; ++i) {
+            bank.deposit(customerSession, 1.00_money);
+            std::string after = bank.getStatement(customerSession, 1);
+            CHECK(after.find("DEPOSIT,1.00," + std::to_string(i) + ".00\n") != std::string::npos);
+        }
+        
+        Banking::MappedFile missing(fixture.testDataDir + "/no_such_file");
+        CHECK_FALSE(missing.refresh());
+        CHECK(missing.view().empty());
+    }
+    
+    SECTION("Batch operations") {
+        std::string adminSession = bank.login("00000000", "9999");
+        bank.createAccount(adminSession, "12345678", "1234");
+        bank.createAccount(adminSession, "87654321", "4321");
+        std::string customerSession = bank.login("12345678", "1234");
+        
+        using Banking::TransactionType;
+        std::vector<Banking::BatchOperation> operations = {
+            {TransactionType::DEPOSIT, 100.00_money, ""},
+            {TransactionType::TRANSFER_OUT, 30.00_money, "87654321"},
+            {TransactionType::DEBIT, 80.00_money, ""},
+            {TransactionType::TRANSFER_OUT, 10.00_money, "99999999"},
+            {TransactionType::TRANSFER_OUT, 10.00_money, "12345678"},
+            {TransactionType::DEPOSIT, 0.00_money, ""},
+            {TransactionType::DEBIT, 20.00_money, ""}
+        };
+        std::vector<std::string> results;
+        REQUIRE(bank.applyBatch(customerSession, operations, results) == "ok");
+        REQUIRE(results.size() == operations.size());
+        CHECK(results[0] == "ok");
+        CHECK(results[1] == "ok");
+        CHECK(results[2] == "error: insufficient funds");
+        CHECK(results[3] == "error: destination account does not exist");
+        CHECK(results[4] == "error: cannot transfer to same account");
+        CHECK(results[5] == "error: amount must be positive");
+        CHECK(results[6] == "ok");
+        
+        std::string statement = bank.getStatement(customerSession, 10);
+        CHECK(statement.find("DEPOSIT,100.00,100.00") != std::string::npos);
+        CHECK(statement.find("TRANSFER_OUT,30.00,70.00") != std::string::npos);
+        CHECK(statement.find("DEBIT,20.00,50.00") != std::string::npos);
+        std::string otherSession = bank.login("87654321", "4321");
+        CHECK(bank.getStatement(otherSession, 10).find("TRANSFER_IN,30.00,30.00") != std::string::npos);
+        CHECK(bank.getBankStatus().find("Total Holdings: 80.00") != std::string::npos);
+        
+        // Whole-batch errors leave no per-operation results
+        CHECK(bank.applyBatch("invalid", operations, results) == "error: invalid session");
+        CHECK(results.empty());
+        CHECK(bank.applyBatch(customerSession, {}, results) == "error: empty batch");
+        std::vector<Banking::BatchOperation> tooMany(Banking::MAX_BATCH_OPERATIONS + 1,
+                                                     {TransactionType::DEPOSIT, 1.00_money, ""});
+        CHECK(bank.applyBatch(customerSession, tooMany, results) == "error: batch too large");
+        
+        // The batch is durable: it survives a restart
+        Bank reopened(fixture.testDataDir);
+        std::string reopenedSession = reopened.login("12345678", "1234");
+        CHECK(reopened.getStatement(reopenedSession, 1).find("DEBIT,20.00,50.00") != std::string::npos);
+    }
+    
+    SECTION("Account index") {
+        Banking::AccountIndex index;
+        CHECK_FALSE(index.contains("12345678"));
+        CHECK(index.insert("12345678"));
+        CHECK_FALSE(index.insert("12345678"));
+        CHECK(index.insert("99999999"));
+        CHECK(index.insert("00000000"));
+        CHECK(index.contains("12345678"));
+        CHECK(index.contains("99999999"));
+        CHECK(index.contains("00000000"));
+        CHECK_FALSE(index.contains("12345679"));
+        CHECK_FALSE(index.insert("1234567"));
+        CHECK_FALSE(index.insert("1234567a"));
+        CHECK_FALSE(index.contains("123456789"));
+        index.clear();
+        CHECK_FALSE(index.contains("12345678"));
+        
+        // The bank's index is rebuilt from the accounts on disk
+        std::string adminSession = bank.login("00000000", "9999");
+        bank.createAccount(adminSession, "12345678", "1234");
+        Bank reopened(fixture.testDataDir);
+        CHECK_FALSE(reopened.login("12345678", "1234").empty());
+        CHECK(reopened.login("87654321", "4321").empty());
+        std::string customerSession = reopened.login("12345678", "1234");
+        reopened.deposit(customerSession, 10.00_money);
+        CHECK(reopened.transfer(customerSession, "87654321", 1.00_money) == "error: destination account does not exist");
+    }
+    
+    SECTION("Hashed PIN storage") {
+        using Banking::CredentialStore;
+        
+        // PBKDF2-HMAC-SHA256 test vectors: password "password", salt "salt"
+        CHECK(CredentialStore::matches(
+            "pbkdf2-sha256$1$73616c74$120fb6cffcf8b32c43e7225256c4f837a86548c92ccc35480805987cb70be17b", "password"));
+        CHECK(CredentialStore::matches(
+            "pbkdf2-sha256$2$73616c74$ae4d0c95af6b46d32d0adff928f06dd02a303f8ef3c251dfd6e2d85a95474c43", "password"));
+        CHECK(CredentialStore::matches(
+            "pbkdf2-sha256$4096$73616c74$c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a", "password"));
+        CHECK_FALSE(CredentialStore::matches(
+            "pbkdf2-sha256$4096$73616c74$c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a", "Password"));
+        CHECK_FALSE(CredentialStore::matches("1234", "1234"));
+        CHECK_FALSE(CredentialStore::matches("pbkdf2-sha256$x$73616c74$00", "1234"));
+        
+        Banking::CredentialConfig config;
+        config.workFactor = 1000;
+        CredentialStore store(config);
+        std::string first = store.hashPin("1234");
+        CHECK(first.rfind("pbkdf2-sha256$1000$", 0) == 0);
+        CHECK(first != store.hashPin("1234"));
+        CHECK(CredentialStore::matches(first, "1234"));
+        CHECK_FALSE(CredentialStore::matches(first, "1235"));
+        
+        store.set("12345678", first);
+        CHECK(store.verify("12345678", "1234"));
+        CHECK_FALSE(store.verify("12345678", "4321"));
+        CHECK_FALSE(store.verify("87654321", "1234"));
+        
+        // The pin file never holds the PIN itself
+        std::string adminSession = bank.login("00000000", "9999");
+        bank.createAccount(adminSession, "12345678", "1234");
+        std::string pinPath = fixture.testDataDir + "/accounts/12345678/pin.txt";
+        std::string stored;
+        std::getline(std::ifstream(pinPath), stored);
+        CHECK(CredentialStore::isHashed(stored));
+        CHECK(stored.find("1234$") == std::string::npos);
+        
+        // A plain-text pin file from before hashing is upgraded at startup
+        std::ofstream(pinPath, std::ios::trunc) << "5555";
+        {
+            Bank reopened(fixture.testDataDir);
+            CHECK_FALSE(reopened.login("12345678", "5555").empty());
+            CHECK(reopened.login("12345678", "1234").empty());
+        }
+        std::getline(std::ifstream(pinPath), stored);
+        CHECK(CredentialStore::isHashed(stored));
+        
+        // With no room to queue a verification, logins fail at once
+        Banking::CredentialConfig saturated;
+        saturated.maxPendingVerifications = 0;
+        Bank busy(fixture.testDataDir, Banking::SessionConfig(), Banking::StatementFormat::Csv,
+                  Banking::TimestampFormat(), saturated);
+        CHECK(busy.login("12345678", "5555").empty());
+    }
+    
+    SECTION("Session ids are random 128-bit hex tokens") {
+        bank.login("00000000", "9999");
+        
+        std::vector<std::vector<std::string>> ids(4);
+        std::vector<std::thread> threads;
+        for (auto& threadIds : ids) {
+            threads.emplace_back([&bank, &threadIds] {
+                for (int i = 0; i < 50; ++i) {
+                    threadIds.push_back(bank.login("00000000", "9999"));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        std::set<std::string> unique;
+        for (const auto& threadIds : ids) {
+            for (const auto& id : threadIds) {
+                REQUIRE(id.size() == 32);
+                CHECK(id.find_first_not_of("0123456789abcdef") == std::string::npos);
+                unique.insert(id);
+            }
+        }
+        CHECK(unique.size() == 200);
+        
+        uint8_t first[16] = {};
+        uint8_t second[16] = {};
+        Banking::secureRandomBytes(first, sizeof(first));
+        Banking::secureRandomBytes(second, sizeof(second));
+        CHECK(std::memcmp(first, second, sizeof(first)) != 0);
+    }
+    
+    SECTION("Typed statement pages with a before cursor") {
+        std::string adminSession = bank.login("00000000", "9999");
+        bank.createAccount(adminSession, "12345678", "1234");
+        std::string customerSession = bank.login("12345678", "1234");
+        
+        // 3001 lines, line n holding balance n
+        std::vector<Banking::BatchOperation> deposits(1000, {Banking::TransactionType::DEPOSIT, 1.00_money, ""});
+        std::vector<std::string> results;
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(bank.applyBatch(customerSession, deposits, results) == "ok");
+        }
+        
+        // Page from the newest back to the start and return every row
+        auto readAllPages = [](Bank& target, const std::string& session) {
+            std::vector<Banking::Transaction> all;
+            std::vector<Banking::Transaction> page;
+            uint64_t next = 0;
+            uint64_t before = UINT64_MAX;
+            do {
+                REQUIRE(target.getTransactions(session, page, next, before, 700) == "ok");
+                REQUIRE_FALSE(page.empty());
+                for (size_t i = 1; i < page.size(); ++i) {
+                    REQUIRE(page[i].sequence > page[i - 1].sequence);
+                }
+                REQUIRE(page.back().sequence < before);
+                CHECK(next == page.front().sequence);
+                all.insert(all.begin(), page.begin(), page.end());
+                before = next;
+            } while (next > 0);
+            return all;
+        };
+        std::vector<Banking::Transaction> all = readAllPages(bank, customerSession);
+        REQUIRE(all.size() == 3001);
+        CHECK(all.front().sequence == 0);
+        CHECK(all.front().type == Banking::TransactionType::ACCOUNT_CREATED);
+        for (size_t i = 0; i < all.size(); ++i) {
+            REQUIRE(all[i].balance == Banking::Money::fromCents(static_cast<int64_t>(i) * 100));
+        }
+        
+        // Appends made after a page was read are found from the end
+        bank.deposit(customerSession, 1.00_money);
+        std::vector<Banking::Transaction> page;
+        uint64_t next = 0;
+        REQUIRE(bank.getTransactions(customerSession, page, next, UINT64_MAX, 2) == "ok");
+        REQUIRE(page.size() == 2);
+        CHECK(page[0].sequence == all.back().sequence);
+        CHECK(page[1].sequence > all.back().sequence);
+        CHECK(page[1].type == Banking::TransactionType::DEPOSIT);
+        CHECK(page[1].balance == 3001.00_money);
+        CHECK(next == all.back().sequence);
+        
+        // A cursor takes the lines that start below it, even mid-line
+        REQUIRE(bank.getTransactions(customerSession, page, next, all[1025].sequence, 3) == "ok");
+        REQUIRE(page.size() == 3);
+        CHECK(page.front().balance == 1022.00_money);
+        CHECK(page.back().balance == 1024.00_money);
+        CHECK(page.back().sequence == all[1024].sequence);
+        REQUIRE(bank.getTransactions(customerSession, page, next, all[1025].sequence + 5, 3) == "ok");
+        CHECK(page.back().balance == 1025.00_money);
+        REQUIRE(bank.getTransactions(customerSession, page, next, 1, 3) == "ok");
+        REQUIRE(page.size() == 1);
+        CHECK(page[0].type == Banking::TransactionType::ACCOUNT_CREATED);
+        CHECK(next == 0);
+        REQUIRE(bank.getTransactions(customerSession, page, next, 0, 3) == "ok");
+        CHECK(page.empty());
+        
+        CHECK(bank.getTransactions(customerSession, page, next, 10, 0) == "error: limit must be positive");
+        CHECK(bank.getTransactions("invalid", page, next) == "error: invalid session");
+        
+        // Same rows from the binary format, at record offsets
+        Bank binary(fixture.testDataDir, Banking::SessionConfig(), Banking::StatementFormat::Binary);
+        std::string binarySession = binary.login("12345678", "1234");
+        std::vector<Banking::Transaction> binaryAll = readAllPages(binary, binarySession);
+        REQUIRE(binaryAll.size() == 3002);
+        for (size_t i = 0; i < binaryAll.size(); ++i) {
+            REQUIRE(binaryAll[i].sequence == i * sizeof(Banking::StatementRecord));
+            REQUIRE(binaryAll[i].balance == Banking::Money::fromCents(static_cast<int64_t>(i) * 100));
+        }
+    }
+    
+    SECTION("HTTP request parsing") {
+        Banking::HttpRequest request;
+        std::string raw = "POST /api/batch?session_id=ab%20cd&x=1+2 HTTP/1.1\r\n"
+                          "host: localhost\r\n"
+                          "CONTENT-TYPE: text/plain \r\n"
+                          "Content-Length: 9\r\n"
+                          "\r\n"
+                          "deposit 1";
+        REQUIRE(Banking::WebServer::parseRequest(raw, request));
+        CHECK(request.method == "POST");
+        CHECK(request.path == "/api/batch");
+        CHECK(request.version == "HTTP/1.1");
+        CHECK(request.queryParams["session_id"] == "ab cd");
+        CHECK(request.queryParams["x"] == "1 2");
+        CHECK(request.header("Host") == "localhost");
+        CHECK(request.header("content-type") == "text/plain");
+        CHECK(request.header("Accept").empty());
+        CHECK(request.body == "deposit 1");
+        
+        Banking::HttpRequest form;
+        REQUIRE(Banking::WebServer::parseRequest("POST /f HTTP/1.1\r\nContent-Type: application/x-www-form-urlencoded\r\n"
+                                                 "\r\na=1&b=%41", form));
+        CHECK(form.queryParams["a"] == "1");
+        CHECK(form.queryParams["b"] == "A");
+        
+        Banking::HttpRequest bad;
+        CHECK(!Banking::WebServer::parseRequest("garbage\r\n\r\n", bad));
+        CHECK(!Banking::WebServer::parseRequest("GET / HTTP/1.1\r\nHost: x\r\n", bad));
+    }
+    
+    SECTION("HTTP requests are framed across reads, pipelined and size-limited") {
+        Banking::WebServer server(0, 2);
+        server.setRequestLimits(256, 16);
+        server.addRoute("POST", "/echo", [](const Banking::HttpRequest& req, Banking::HttpResponse& res) {
+            res.body = std::string(req.body);
+        });
+        server.addRoute("GET", "/ping", [](const Banking::HttpRequest&, Banking::HttpResponse& res) {
+            res.body = "pong";
+        });
+        REQUIRE(server.start());
+        int port = server.getPort();
+        REQUIRE(port > 0);
+        
+        // Headers split mid-line and across the terminator
+        std::string response = httpExchange(port, {"GET /ping HTTP/1.1\r\nHo", "st: x\r\n\r", "\n"});
+        CHECK(response.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+        CHECK(response.find("Content-Length: 4\r\n") != std::string::npos);
+        CHECK(response.substr(response.size() - 4) == "pong");
+        
+        // A Content-Length body split across reads
+        response = httpExchange(port, {"POST /echo HTTP/1.1\r\nContent-Length: 11\r\n\r\nhello", " world"});
+        CHECK(response.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+        CHECK(response.substr(response.size() - 11) == "hello world");
+        
+        // Pipelined requests in one write are answered in order
+        response = httpExchange(port, {"POST /echo HTTP/1.1\r\nContent-Length: 5\r\n\r\nfirst"
+                                       "POST /echo HTTP/1.1\r\nContent-Length: 6\r\n\r\nsecond"
+                                       "GET /ping HTTP/1.1\r\n\r\n"});
+        CHECK(countOccurrences(response, "HTTP/1.1 200 OK") == 3);
+        size_t first = response.find("first");
+        size_t second = response.find("second");
+        size_t pong = response.find("pong");
+        REQUIRE(first != std::string::npos);
+        REQUIRE(second != std::string::npos);
+        REQUIRE(pong != std::string::npos);
+        CHECK(first < second);
+        CHECK(second < pong);
+        
+        // A request split after a pipelined one completes on the next read
+        response = httpExchange(port, {"GET /ping HTTP/1.1\r\n\r\nPOST /echo HTTP/1.1\r\nContent-Len", "gth: 3\r\n\r\nabc"});
+        CHECK(countOccurrences(response, "HTTP/1.1 200 OK") == 2);
+        CHECK(response.substr(response.size() - 3) == "abc");
+        
+        // Header block over the limit, with and without its terminator
+        response = httpExchange(port, {"GET /ping HTTP/1.1\r\nX-Padding: " + std::string(300, 'a') + "\r\n\r\n"});
+        CHECK(response.rfind("HTTP/1.1 431 ", 0) == 0);
+        CHECK(response.find("Connection: close\r\n") != std::string::npos);
+        response = httpExchange(port, {"GET /ping HTTP/1.1\r\nX-Padding: " + std::string(300, 'a')});
+        CHECK(response.rfind("HTTP/1.1 431 ", 0) == 0);
+        
+        // Body over the limit is rejected before it is read
+        response = httpExchange(port, {"POST /echo HTTP/1.1\r\nContent-Length: 17\r\n\r\n"});
+        CHECK(response.rfind("HTTP/1.1 413 ", 0) == 0);
+        response = httpExchange(port, {"POST /echo HTTP/1.1\r\nContent-Length: 1234567890123456789\r\n\r\n"});
+        CHECK(response.rfind("HTTP/1.1 413 ", 0) == 0);
+        
+        // Chunked bodies are not supported
+        response = httpExchange(port, {"POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n0\r\n\r\n"});
+        CHECK(response.rfind("HTTP/1.1 501 ", 0) == 0);
+        
+        // Malformed request line or Content-Length
+        response = httpExchange(port, {"garbage\r\n\r\n"});
+        CHECK(response.rfind("HTTP/1.1 400 ", 0) == 0);
+        response = httpExchange(port, {"POST /echo HTTP/1.1\r\nContent-Length: 1x\r\n\r\n"});
+        CHECK(response.rfind("HTTP/1.1 400 ", 0) == 0);
+        
+        // Repeated Content-Length headers must agree
+        response = httpExchange(port, {"POST /echo HTTP/1.1\r\nContent-Length: 3\r\ncontent-length: 13\r\n\r\n"
+                                       "abcGET /ping HTTP/1.1\r\n\r\n"});
+        CHECK(response.rfind("HTTP/1.1 400 ", 0) == 0);
+        CHECK(response.find("abc") == std::string::npos);
+        CHECK(response.find("pong") == std::string::npos);
+        response = httpExchange(port, {"POST /echo HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 3\r\n"
+                                       "Connection: close\r\n\r\nabc"});
+        CHECK(response.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+        CHECK(response.find("\r\n\r\nabc") != std::string::npos);
+        
+        // A good request after a pipelined bad one is not served
+        response = httpExchange(port, {"garbage\r\n\r\nGET /ping HTTP/1.1\r\n\r\n"});
+        CHECK(response.rfind("HTTP/1.1 400 ", 0) == 0);
+        CHECK(response.find("pong") == std::string::npos);
+        
+        server.stop();
+    }
+    
+    SECTION("Routes match static segments before parameters and backtrack") {
+        Banking::WebServer server(0, 1);
+        auto reply = [](const std::string& name) {
+            return [name](const Banking::HttpRequest& req, Banking::HttpResponse& res) {
+                res.body = name + " id=" + std::string(req.pathParam("id")) + " to=" + std::string(req.pathParam("to"));
+            };
+        };
+        server.addRoute("GET", "/api/accounts/{id}/statement", reply("statement"));
+        server.addRoute("GET", "/api/accounts/{id}/transfers/{to}", reply("transfer"));
+        server.addRoute("GET", "/api/accounts/admin", reply("admin"));
+        server.addRoute("GET", "/api/accounts/admin/status", reply("status"));
+        server.addRoute("GET", "/api/accounts", reply("list"));
+        server.addRoute("POST", "/api/accounts/{id}", reply("update"));
+        REQUIRE(server.start());
+        
+        auto get = [&](const std::string& method, const std::string& path) {
+            std::string response = httpExchange(server.getPort(), {method + " " + path + " HTTP/1.1\r\n\r\n"});
+            if (response.rfind("HTTP/1.1 200 OK", 0) != 0) {
+                return response.substr(0, response.find("\r\n"));
+            }
+            return response.substr(response.find("\r\n\r\n") + 4);
+        };
+        
+        CHECK(get("GET", "/api/accounts/12345678/statement") == "statement id=12345678 to=");
+        CHECK(get("GET", "/api/accounts/12345678/transfers/87654321") == "transfer id=12345678 to=87654321");
+        CHECK(get("GET", "/api/accounts") == "list id= to=");
+        
+        // Static segments win over a parameter at the same position
+        CHECK(get("GET", "/api/accounts/admin") == "admin id= to=");
+        CHECK(get("GET", "/api/accounts/admin/status") == "status id= to=");
+        
+        // "admin" matches the static branch, which has no /statement below
+        // it, so matching backtracks and binds the parameter instead
+        CHECK(get("GET", "/api/accounts/admin/statement") == "statement id=admin to=");
+        CHECK(get("GET", "/api/accounts/admin/transfers/1") == "transfer id=admin to=1");
+        
+        // Parameters match exactly one non-empty segment
+        CHECK(get("GET", "/api/accounts//statement") == "HTTP/1.1 404 Not Found");
+        CHECK(get("GET", "/api/accounts/1/2/statement") == "HTTP/1.1 404 Not Found");
+        CHECK(get("GET", "/api/accounts/1/statement/extra") == "HTTP/1.1 404 Not Found");
+        
+        // Each method has its own tree
+        CHECK(get("POST", "/api/accounts/42") == "update id=42 to=");
+        CHECK(get("GET", "/api/accounts/42") == "HTTP/1.1 404 Not Found");
+        CHECK(get("DELETE", "/api/accounts/42") == "HTTP/1.1 404 Not Found");
+        
+        server.stop();
+    }
+    
+    SECTION("A login storm cannot occupy every HTTP worker") {
+        // Slow hashes, one verifier and room for two logins, below the
+        // server's three workers
+        Banking::CredentialConfig credentials;
+        credentials.workFactor = 400000;
+        credentials.verifyThreads = 1;
+        credentials.maxPendingVerifications = 2;
+        Bank slow(fixture.testDataDir, Banking::SessionConfig(), Banking::StatementFormat::Csv,
+                  Banking::TimestampFormat(), credentials);
+        slow.createAccount(slow.login("00000000", "9999"), "12345678", "1234");
+        
+        auto started = std::chrono::steady_clock::now();
+        std::string customerSession = slow.login("12345678", "1234");
+        auto verifyTime = std::chrono::steady_clock::now() - started;
+        REQUIRE_FALSE(customerSession.empty());
+        
+        Banking::WebServer server(0, 3);
+        server.addRoute("GET", "/login", [&slow](const Banking::HttpRequest&, Banking::HttpResponse& res) {
+            res.body = slow.login("12345678", "1234").empty() ? "refused" : "ok";
+        });
+        server.addRoute("GET", "/deposit", [&](const Banking::HttpRequest&, Banking::HttpResponse& res) {
+            res.body = slow.deposit(customerSession, 1.00_money);
+        });
+        REQUIRE(server.start());
+        auto body = [&](const std::string& path) {
+            std::string response = httpExchange(server.getPort(), {"GET " + path + " HTTP/1.1\r\n\r\n"});
+            size_t bodyStart = response.find("\r\n\r\n");
+            return bodyStart == std::string::npos ? response : response.substr(bodyStart + 4);
+        };
+        
+        std::vector<std::string> logins(8);
+        std::vector<std::thread> storm;
+        for (auto& login : logins) {
+            storm.emplace_back([&] { login = body("/login"); });
+        }
+        std::this_thread::sleep_for(verifyTime / 4);
+        
+        // The deposit finds a free worker instead of waiting behind logins
+        started = std::chrono::steady_clock::now();
+        CHECK(body("/deposit") == "ok");
+        CHECK(std::chrono::steady_clock::now() - started < verifyTime);
+        
+        for (auto& thread : storm) {
+            thread.join();
+        }
+        CHECK(std::count(logins.begin(), logins.end(), "ok") >= 1);
+        CHECK(std::count(logins.begin(), logins.end(), "refused") >= 1);
+        CHECK(std::count(logins.begin(), logins.end(), "ok") + std::count(logins.begin(), logins.end(), "refused") == 8);
+        server.stop();
+    }
+    
+    SECTION("Statement page limits are validated and clamped") {
+        // Query numbers are plain unsigned decimals; anything else is refused
+        Banking::WebServer server(0, 1);
+        server.addRoute("GET", "/page", [](const Banking::HttpRequest& req, Banking::HttpResponse& res) {
+            uint64_t before = UINT64_MAX;
+            uint64_t limit = Banking::STATEMENT_PAGE_SIZE;
+            if (!req.queryNumber("before", before)) {
+                res.setBadRequest("before must be a sequence number");
+                return;
+            }
+            if (!req.queryNumber("limit", limit)) {
+                res.setBadRequest("limit must be a number");
+                return;
+            }
+            res.body = std::to_string(before) + " " + std::to_string(limit);
+        });
+        REQUIRE(server.start());
+        auto get = [&](const std::string& target) {
+            std::string response = httpExchange(server.getPort(), {"GET " + target + " HTTP/1.1\r\n\r\n"});
+            if (response.rfind("HTTP/1.1 200 OK", 0) != 0) {
+                return response.substr(0, response.find("\r\n"));
+            }
+            return response.substr(response.find("\r\n\r\n") + 4);
+        };
+        
+        CHECK(get("/page") == "18446744073709551615 50");
+        CHECK(get("/page?before=41&limit=7") == "41 7");
+        CHECK(get("/page?limit=0") == "18446744073709551615 0");
+        CHECK(get("/page?before=18446744073709551615") == "18446744073709551615 50");
+        for (const char* bad : {"abc", "", "-1", "+5", "12x", "1.5", "%2010", "18446744073709551616"}) {
+            CHECK(get(std::string("/page?before=") + bad) == "HTTP/1.1 400 Bad Request");
+            CHECK(get(std::string("/page?limit=") + bad) == "HTTP/1.1 400 Bad Request");
+        }
+        server.stop();
+        
+        // A page never holds more than MAX_STATEMENT_PAGE_SIZE transactions
+        std::string adminSession = bank.login("00000000", "9999");
+        bank.createAccount(adminSession, "12345678", "1234");
+        std::string customerSession = bank.login("12345678", "1234");
+        std::vector<Banking::BatchOperation> deposits(Banking::MAX_STATEMENT_PAGE_SIZE + 10,
+                                                     {Banking::TransactionType::DEPOSIT, 1.00_money, ""});
+        std::vector<std::string> results;
+        REQUIRE(bank.applyBatch(customerSession, deposits, results) == "ok");
+        
+        std::vector<Banking::Transaction> page;
+        uint64_t next = 0;
+        CHECK(bank.getTransactions(customerSession, page, next, UINT64_MAX, SIZE_MAX) == "ok");
+        CHECK(page.size() == Banking::MAX_STATEMENT_PAGE_SIZE);
+        CHECK(page.back().balance == Banking::Money::fromCents(100 * (Banking::MAX_STATEMENT_PAGE_SIZE + 10)));
+        CHECK(next == page.front().sequence);
+        CHECK(bank.getTransactions(customerSession, page, next, next, Banking::MAX_STATEMENT_PAGE_SIZE + 1) == "ok");
+        CHECK(page.size() == 11);
+        CHECK(next == 0);
+        CHECK(bank.getTransactions(customerSession, page, next, UINT64_MAX, 0) == "error: limit must be positive");
+    }
+    
+    SECTION("JSON string escaping matches a byte-by-byte reference") {
+        auto reference = [](std::string_view text) {
+            static const char* hex = "0123456789abcdef";
+            std::string out;
+            for (char c : text) {
+                unsigned char byte = static_cast<unsigned char>(c);
+                if (c == '"') out += "\\\"";
+                else if (c == '\\') out += "\\\\";
+                else if (c == '\n') out += "\\n";
+                else if (c == '\r') out += "\\r";
+                else if (c == '\t') out += "\\t";
+                else if (byte < 0x20) out += std::string("\\u00") + hex[byte >> 4] + hex[byte & 0xf];
+                else out += c;
+            }
+            return out;
+        };
+        auto escape = [](std::string_view text) {
+            std::string out = "prefix";
+            Banking::JsonWriter::appendEscaped(out, text);
+            return out.substr(6);
+        };
+        
+        CHECK(escape("") == "");
+        CHECK(escape("plain text, no escapes") == "plain text, no escapes");
+        CHECK(escape("say \"hi\"\\\n") == "say \\\"hi\\\"\\\\\\n");
+        CHECK(escape(std::string("\0\x01\x1f\x7f", 4)) == std::string("\\u0000\\u0001\\u001f\x7f"));
+        
+        // UTF-8 passes through unescaped, in whole words and in the tail
+        std::string utf8 = "h\xc3\xa9llo \xe2\x82\xac 12,50 \xf0\x9f\x92\xb0 caf\xc3\xa9";
+        CHECK(escape(utf8) == utf8);
+        
+        // Every byte value at every offset of two 8-byte words plus a tail,
+        // over fillers that sit next to the word test's thresholds
+        size_t mismatches = 0;
+        std::string firstMismatch;
+        auto compare = [&](const std::string& text) {
+            if (escape(text) != reference(text)) {
+                if (mismatches++ == 0) firstMismatch = text;
+            }
+        };
+        for (char filler : {'x', ' ', '!', '\x1f', '"', '\x7f', '\x80', '\xff'}) {
+            for (size_t length = 1; length <= 19; ++length) {
+                for (size_t offset = 0; offset < length; ++offset) {
+                    for (int byte = 0; byte < 256; ++byte) {
+                        std::string text(length, filler);
+                        text[offset] = static_cast<char>(byte);
+                        compare(text);
+                    }
+                }
+            }
+        }
+        
+        // Pairs of escapes inside one word and straddling a word boundary
+        for (char first : {'"', '\\', '\n', '\x01'}) {
+            for (char second : {'"', '\\', '\t', '\x1f'}) {
+                for (size_t i = 0; i < 24; ++i) {
+                    for (size_t j = i + 1; j < 24; ++j) {
+                        std::string text = "abcdefgh\xc3\xa9jklmnopqrstuvw";
+                        text[i] = first;
+                        text[j] = second;
+                        compare(text);
+                    }
+                }
+            }
+        }
+        INFO("first mismatch: " << reference(firstMismatch));
+        CHECK(mismatches == 0);
+    }
+    
+    SECTION("HEAD is answered like GET without the body") {
+        Banking::WebServer server(0, 1);
+        server.addRoute("GET", "/hello", [](const Banking::HttpRequest&, Banking::HttpResponse& res) {
+            res.body = "hello world";
+        });
+        REQUIRE(server.start());
+        
+        std::string head = httpExchange(server.getPort(), {"HEAD /hello HTTP/1.1\r\nConnection: close\r\n\r\n"});
+        CHECK(head.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+        CHECK(head.find("Content-Length: 11\r\n") != std::string::npos);
+        CHECK(head.size() == head.find("\r\n\r\n") + 4);
+        
+        // The next pipelined request is framed right after the bodiless reply
+        std::string both = httpExchange(server.getPort(), {"HEAD /hello HTTP/1.1\r\n\r\n"
+                                                           "GET /hello HTTP/1.1\r\nConnection: close\r\n\r\n"});
+        CHECK(countOccurrences(both, "HTTP/1.1 200 OK") == 2);
+        CHECK(countOccurrences(both, "hello world") == 1);
+        CHECK(both.size() == both.rfind("hello world") + 11);
+        
+        std::string missing = httpExchange(server.getPort(), {"HEAD /nowhere HTTP/1.1\r\nConnection: close\r\n\r\n"});
+        CHECK(missing.rfind("HTTP/1.1 404 Not Found\r\n", 0) == 0);
+        CHECK(missing.size() == missing.find("\r\n\r\n") + 4);
+        server.stop();
+    }
+    
+    SECTION("Static assets negotiate gzip and answer revalidation with 304") {
+        std::string script;
+        for (int i = 0; i < 200; ++i) {
+            script += "console.log('banking " + std::to_string(i % 7) + "');\n";
+        }
+        Banking::StaticAsset asset("application/javascript", script);
+        Banking::WebServer server(0, 1);
+        server.addRoute("GET", "/app.js", [&asset](const Banking::HttpRequest& req, Banking::HttpResponse& res) {
+            asset.serve(req, res);
+        });
+        REQUIRE(server.start());
+        
+        auto get = [&](const std::string& extraHeaders) {
+            return httpExchange(server.getPort(), {"GET /app.js HTTP/1.1\r\n" + extraHeaders + "Connection: close\r\n\r\n"});
+        };
+        auto headerValue = [](const std::string& response, const std::string& name) {
+            size_t pos = response.find("\r\n" + name + ": ");
+            if (pos == std::string::npos) return std::string();
+            pos += name.size() + 4;
+            return response.substr(pos, response.find("\r\n", pos) - pos);
+        };
+        auto bodyOf = [](const std::string& response) {
+            size_t end = response.find("\r\n\r\n");
+            return end == std::string::npos ? std::string() : response.substr(end + 4);
+        };
+        
+        std::string plain = get("");
+        CHECK(plain.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+        CHECK(headerValue(plain, "Content-Type") == "application/javascript");
+        CHECK(headerValue(plain, "Content-Encoding").empty());
+        CHECK(bodyOf(plain) == script);
+        std::string identityEtag = headerValue(plain, "ETag");
+        REQUIRE(identityEtag.size() > 2);
+        CHECK(identityEtag.front() == '"');
+        
+        // Encodings the client refuses or does not name get the identity body
+        for (const char* refused : {"gzip;q=0", "gzip; q=0.0", "identity", "deflate, br"}) {
+            std::string res = get(std::string("Accept-Encoding: ") + refused + "\r\n");
+            CHECK(headerValue(res, "Content-Encoding").empty());
+            CHECK(headerValue(res, "ETag") == identityEtag);
+            CHECK(bodyOf(res) == script);
+        }
+        
+        std::string gzipEtag = identityEtag;
+        if (asset.isCompressed()) {
+            CHECK(headerValue(plain, "Vary") == "Accept-Encoding");
+            for (const char* accepted : {"gzip", "deflate, gzip;q=0.5", "x-gzip", "*"}) {
+                std::string res = get(std::string("Accept-Encoding: ") + accepted + "\r\n");
+                CHECK(res.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+                CHECK(headerValue(res, "Content-Encoding") == "gzip");
+                CHECK(headerValue(res, "Vary") == "Accept-Encoding");
+                std::string body = bodyOf(res);
+                CHECK(body.size() < script.size());
+                CHECK(headerValue(res, "Content-Length") == std::to_string(body.size()));
+                REQUIRE(body.size() > 2);
+                CHECK(static_cast<unsigned char>(body[0]) == 0x1f);
+                CHECK(static_cast<unsigned char>(body[1]) == 0x8b);
+                gzipEtag = headerValue(res, "ETag");
+            }
+            CHECK(gzipEtag != identityEtag);
+        } else {
+            CHECK(headerValue(get("Accept-Encoding: gzip\r\n"), "Content-Encoding").empty());
+        }
+        
+        // A current validator, alone, in a list, weak or as * gets 304 with no body
+        for (const std::string& validator : {identityEtag, "\"stale\", " + identityEtag, "W/" + identityEtag, std::string("*")}) {
+            std::string res = get("If-None-Match: " + validator + "\r\n");
+            CHECK(res.rfind("HTTP/1.1 304 Not Modified\r\n", 0) == 0);
+            CHECK(headerValue(res, "ETag") == identityEtag);
+            CHECK(headerValue(res, "Content-Type").empty());
+            CHECK(res.size() == res.find("\r\n\r\n") + 4);
+        }
+        if (asset.isCompressed()) {
+            std::string res = get("Accept-Encoding: gzip\r\nIf-None-Match: W/\"stale\", " + gzipEtag + "\r\n");
+            CHECK(res.rfind("HTTP/1.1 304 Not Modified\r\n", 0) == 0);
+            CHECK(headerValue(res, "Vary") == "Accept-Encoding");
+            CHECK(res.size() == res.find("\r\n\r\n") + 4);
+            
+            // The gzip validator does not revalidate the identity representation
+            std::string other = get("If-None-Match: " + gzipEtag + "\r\n");
+            CHECK(other.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+            CHECK(bodyOf(other) == script);
+        }
+        
+        for (const char* stale : {"\"stale\"", "\"stale\", W/\"older\"", ""}) {
+            std::string res = get(std::string("If-None-Match: ") + stale + "\r\n");
+            CHECK(res.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+            CHECK(bodyOf(res) == script);
+        }
+        server.stop();
+    }
+    
+    SECTION("Keep-alive connections honour Connection, HTTP/1.0, the request cap and the idle timeout") {
+        Banking::WebServer server(0, 1);
+        server.setKeepAlive(1, 3);
+        server.addRoute("GET", "/ping", [](const Banking::HttpRequest&, Banking::HttpResponse& res) {
+            res.body = "pong";
+        });
+        REQUIRE(server.start());
+        std::string get11 = "GET /ping HTTP/1.1\r\n\r\n";
+        
+        // The third request on a connection is the last one served
+        std::string capped = httpExchange(server.getPort(), {get11 + get11 + get11 + get11 + get11});
+        CHECK(countOccurrences(capped, "HTTP/1.1 200 OK") == 3);
+        CHECK(countOccurrences(capped, "Connection: keep-alive\r\nKeep-Alive: timeout=1, max=3\r\n") == 2);
+        CHECK(countOccurrences(capped, "Connection: close\r\n") == 1);
+        std::string lastReply = "Connection: close\r\n\r\npong";
+        CHECK(capped.size() == capped.rfind(lastReply) + lastReply.size());
+        
+        // Connection: close ends the connection after its response
+        std::string closed = httpExchange(server.getPort(), {"GET /ping HTTP/1.1\r\nConnection: Close\r\n\r\n" + get11});
+        CHECK(countOccurrences(closed, "HTTP/1.1 200 OK") == 1);
+        CHECK(closed.find("Connection: close\r\n") != std::string::npos);
+        
+        // HTTP/1.0 closes unless the client asks for keep-alive
+        std::string get10 = "GET /ping HTTP/1.0\r\n\r\n";
+        std::string http10 = httpExchange(server.getPort(), {get10 + get10});
+        CHECK(countOccurrences(http10, "200 OK") == 1);
+        CHECK(http10.find("Connection: close\r\n") != std::string::npos);
+        std::string kept10 = httpExchange(server.getPort(), {"GET /ping HTTP/1.0\r\nConnection: keep-alive\r\n\r\n" + get10 + get10});
+        CHECK(countOccurrences(kept10, "200 OK") == 2);
+        CHECK(countOccurrences(kept10, "Connection: keep-alive\r\n") == 1);
+        CHECK(countOccurrences(kept10, "Connection: close\r\n") == 1);
+        
+        // An HTTP/1.1 connection stays open between requests until it has
+        // been idle for the timeout, then the server closes it
+        int fd = connectLoopback(server.getPort());
+        REQUIRE(fd >= 0);
+        send(fd, get11.data(), get11.size(), MSG_NOSIGNAL);
+        CHECK(readUntil(fd, "pong").find("Connection: keep-alive\r\n") != std::string::npos);
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        send(fd, get11.data(), get11.size(), MSG_NOSIGNAL);
+        CHECK(readUntil(fd, "pong").rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+        
+        auto idleFrom = std::chrono::steady_clock::now();
+        char byte;
+        CHECK(recv(fd, &byte, 1, 0) == 0);
+        auto idleFor = std::chrono::steady_clock::now() - idleFrom;
+        CHECK(idleFor >= std::chrono::milliseconds(900));
+        CHECK(idleFor < std::chrono::milliseconds(4000));
+        close(fd);
+        server.stop();
+    }
+    
+    SECTION("Large responses reach slow readers intact and stalled readers time out") {
+        std::string payload(4 * 1024 * 1024, '\0');
+        for (size_t i = 0; i < payload.size(); ++i) {
+            payload[i] = static_cast<char>('a' + (i * 7 + i / 4096) % 26);
+        }
+        Banking::WebServer server(0, 2);
+        server.setWriteTimeout(500);
+        server.addRoute("GET", "/large", [&payload](const Banking::HttpRequest&, Banking::HttpResponse& res) {
+            res.staticBody = payload;
+        });
+        REQUIRE(server.start());
+        std::string request = "GET /large HTTP/1.1\r\nConnection: close\r\n\r\n";
+        
+        // Reads in small pieces with pauses: the server's writes keep
+        // filling the socket buffer and waiting for it to drain
+        int slow = connectLoopback(server.getPort(), 16 * 1024);
+        REQUIRE(slow >= 0);
+        send(slow, request.data(), request.size(), MSG_NOSIGNAL);
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        std::string received;
+        char buffer[8192];
+        ssize_t n;
+        while ((n = recv(slow, buffer, sizeof(buffer), 0)) > 0) {
+            received.append(buffer, static_cast<size_t>(n));
+            if (received.size() % (512 * 1024) < static_cast<size_t>(n)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+        close(slow);
+        size_t headEnd = received.find("\r\n\r\n");
+        REQUIRE(headEnd != std::string::npos);
+        CHECK(received.find("Content-Length: " + std::to_string(payload.size()) + "\r\n") < headEnd);
+        CHECK(received.size() - headEnd - 4 == payload.size());
+        CHECK(received.compare(headEnd + 4, std::string::npos, payload) == 0);
+        
+        // A client that stops reading is cut off after the write timeout
+        int stalled = connectLoopback(server.getPort(), 16 * 1024);
+        REQUIRE(stalled >= 0);
+        send(stalled, request.data(), request.size(), MSG_NOSIGNAL);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+        std::string partial;
+        while ((n = recv(stalled, buffer, sizeof(buffer), 0)) > 0) {
+            partial.append(buffer, static_cast<size_t>(n));
+        }
+        close(stalled);
+        CHECK(partial.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+        CHECK(partial.size() < payload.size());
+        
+        // The worker is free again for the next client
+        std::string next = httpExchange(server.getPort(), {request});
+        CHECK(next.size() == next.find("\r\n\r\n") + 4 + payload.size());
+        server.stop();
+    }
 }
\ No newline at end of file
@@ -0,0 +1,176 @@
+// Microbenchmark: HTTP request parsing cost per request.
+// Compares the original istringstream/std::map parser against
+// WebServer::parseRequest on typical requests from the web UI.
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "WebServer.h"
+
+namespace legacy {
+
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::map<std::string, std::string> headers;
+    std::string body;
+    std::map<std::string, std::string> queryParams;
+};
+
+std::string urlDecode(const std::string& str) {
+    std::string result;
+    for (size_t i = 0; i < str.length(); ++i) {
+        if (str[i] == '%' && i + 2 < str.length()) {
+            int value;
+            std::istringstream iss(str.substr(i + 1, 2));
+            if (iss >> std::hex >> value) {
+                result += static_cast<char>(value);
+                i += 2;
+            } else {
+                result += str[i];
+            }
+        } else if (str[i] == '+') {
+            result += ' ';
+        } else {
+            result += str[i];
+        }
+    }
+    return result;
+}
+
+std::map<std::string, std::string> parseQueryString(const std::string& query) {
+    std::map<std::string, std::string> params;
+    std::istringstream stream(query);
+    std::string pair;
+    while (std::getline(stream, pair, '&')) {
+        size_t eqPos = pair.find('=');
+        if (eqPos != std::string::npos) {
+            params[urlDecode(pair.substr(0, eqPos))] = urlDecode(pair.substr(eqPos + 1));
+        }
+    }
+    return params;
+}
+
+// The parser WebServer used before the string_view rewrite
+HttpRequest parseRequest(const std::string& rawRequest) {
+    HttpRequest request;
+    std::istringstream stream(rawRequest);
+    std::string line;
+
+    if (std::getline(stream, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        std::istringstream lineStream(line);
+        std::string pathWithQuery;
+        lineStream >> request.method >> pathWithQuery;
+        size_t queryPos = pathWithQuery.find('?');
+        if (queryPos != std::string::npos) {
+            request.path = pathWithQuery.substr(0, queryPos);
+            request.queryParams = parseQueryString(pathWithQuery.substr(queryPos + 1));
+        } else {
+            request.path = pathWithQuery;
+        }
+    }
+
+    while (std::getline(stream, line) && line != "\r" && !line.empty()) {
+        if (line.back() == '\r') {
+            line.pop_back();
+        }
+        size_t colonPos = line.find(':');
+        if (colonPos != std::string::npos) {
+            std::string key = line.substr(0, colonPos);
+            std::string value = line.substr(colonPos + 1);
+            if (!value.empty() && value[0] == ' ') {
+                value = value.substr(1);
+            }
+            request.headers[key] = value;
+        }
+    }
+
+    std::ostringstream bodyStream;
+    bodyStream << stream.rdbuf();
+    request.body = bodyStream.str();
+
+    if (request.headers["Content-Type"] == "application/x-www-form-urlencoded") {
+        for (const auto& [key, value] : parseQueryString(request.body)) {
+            request.queryParams[key] = value;
+        }
+    }
+    return request;
+}
+
+} // namespace legacy
+
+namespace {
+
+const std::vector<std::pair<std::string, std::string>> SAMPLES = {
+    {"statement poll",
+     "GET /api/statement?session_id=0123456789abcdef0123456789abcdef&lines=10 HTTP/1.1\r\n"
+     "Host: localhost:8080\r\n"
+     "Connection: keep-alive\r\n"
+     "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0 Safari/537.36\r\n"
+     "Accept: */*\r\n"
+     "Referer: http://localhost:8080/\r\n"
+     "Accept-Encoding: gzip, deflate, br\r\n"
+     "Accept-Language: en-GB,en;q=0.9\r\n"
+     "\r\n"},
+    {"form post",
+     "POST /api/transfer HTTP/1.1\r\n"
+     "Host: localhost:8080\r\n"
+     "Content-Type: application/x-www-form-urlencoded\r\n"
+     "Content-Length: 77\r\n"
+     "\r\n"
+     "session_id=0123456789abcdef0123456789abcdef&to_account=87654321&amount=12.50"},
+    {"static asset",
+     "GET /style.css HTTP/1.1\r\n"
+     "Host: localhost:8080\r\n"
+     "Accept: text/css,*/*;q=0.1\r\n"
+     "\r\n"},
+};
+
+template <typename Fn>
+double nanosPerCall(int iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = 200000;
+    if (argc > 1) {
+        iterations = std::atoi(argv[1]);
+    }
+
+    size_t sink = 0;
+    std::cout << "request           legacy ns/req   string_view ns/req   speedup\n";
+    for (const auto& [name, raw] : SAMPLES) {
+        double before = nanosPerCall(iterations, [&] {
+            legacy::HttpRequest request = legacy::parseRequest(raw);
+            sink += request.path.size() + request.queryParams.size();
+        });
+        double after = nanosPerCall(iterations, [&] {
+            Banking::HttpRequest request;
+            Banking::WebServer::parseRequest(raw, request);
+            sink += request.path.size() + request.queryParams.size();
+        });
+
+        std::cout.width(18);
+        std::cout << std::left << name;
+        std::cout.width(16);
+        std::cout << static_cast<long>(before);
+        std::cout.width(21);
+        std::cout << static_cast<long>(after);
+        std::cout << before / after << "x\n";
+    }
+
+    return sink == 0 ? 1 : 0;
+}
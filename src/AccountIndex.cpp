@@ -0,0 +1,59 @@
+#include "AccountIndex.h"
+
+namespace Banking {
+
+AccountIndex::AccountIndex() {
+    for (auto& block : blocks_) {
+        block.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+AccountIndex::~AccountIndex() {
+    clear();
+}
+
+bool AccountIndex::parse(std::string_view accountNumber, uint32_t& number) {
+    if (accountNumber.size() != 8) return false;
+    number = 0;
+    for (char c : accountNumber) {
+        if (c < '0' || c > '9') return false;
+        number = number * 10 + static_cast<uint32_t>(c - '0');
+    }
+    return true;
+}
+
+bool AccountIndex::contains(std::string_view accountNumber) const {
+    uint32_t number;
+    if (!parse(accountNumber, number)) return false;
+
+    const Word* block = blocks_[number / BLOCK_BITS].load(std::memory_order_acquire);
+    if (block == nullptr) return false;
+    uint32_t bit = number % BLOCK_BITS;
+    return (block[bit / 64].load(std::memory_order_acquire) >> (bit % 64)) & 1;
+}
+
+bool AccountIndex::insert(std::string_view accountNumber) {
+    uint32_t number;
+    if (!parse(accountNumber, number)) return false;
+
+    std::lock_guard<std::mutex> lock(insertMutex_);
+    auto& slot = blocks_[number / BLOCK_BITS];
+    Word* block = slot.load(std::memory_order_relaxed);
+    if (block == nullptr) {
+        block = new Word[BLOCK_WORDS]();
+        slot.store(block, std::memory_order_release);
+    }
+    uint32_t bit = number % BLOCK_BITS;
+    uint64_t mask = uint64_t{1} << (bit % 64);
+    return (block[bit / 64].fetch_or(mask, std::memory_order_release) & mask) == 0;
+}
+
+void AccountIndex::clear() {
+    // Only called while no other thread is using the index
+    std::lock_guard<std::mutex> lock(insertMutex_);
+    for (auto& slot : blocks_) {
+        delete[] slot.exchange(nullptr, std::memory_order_relaxed);
+    }
+}
+
+} // namespace Banking
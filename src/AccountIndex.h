@@ -0,0 +1,49 @@
+#ifndef ACCOUNT_INDEX_H
+#define ACCOUNT_INDEX_H
+
+#include <string_view>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace Banking {
+
+// Set of existing 8-digit account numbers, held as a bitmap over the whole
+// number space. The bitmap is split into blocks of BLOCK_BITS consecutive
+// numbers that are only allocated once an account falls in them, so a bank
+// with a few thousand accounts uses a few blocks rather than 12.5 MB.
+// contains() never locks; insert() serializes with other inserts.
+class AccountIndex {
+public:
+    AccountIndex();
+    ~AccountIndex();
+
+    AccountIndex(const AccountIndex&) = delete;
+    AccountIndex& operator=(const AccountIndex&) = delete;
+
+    // False for anything that is not exactly 8 digits
+    bool contains(std::string_view accountNumber) const;
+
+    // False if the number is not 8 digits or is already present
+    bool insert(std::string_view accountNumber);
+
+    void clear();
+
+private:
+    static constexpr uint32_t ACCOUNT_NUMBERS = 100000000;
+    static constexpr uint32_t BLOCK_BITS = 1 << 16;
+    static constexpr uint32_t BLOCK_WORDS = BLOCK_BITS / 64;
+    static constexpr uint32_t BLOCK_COUNT = (ACCOUNT_NUMBERS + BLOCK_BITS - 1) / BLOCK_BITS;
+
+    // Each block is an array of BLOCK_WORDS words
+    using Word = std::atomic<uint64_t>;
+    std::array<std::atomic<Word*>, BLOCK_COUNT> blocks_;
+    std::mutex insertMutex_;
+
+    static bool parse(std::string_view accountNumber, uint32_t& number);
+};
+
+} // namespace Banking
+
+#endif // ACCOUNT_INDEX_H
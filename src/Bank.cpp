@@ -1,52 +1,67 @@
 #include "Bank.h"
+#include "SecureRandom.h"
 #include <fstream>
 #include <sstream>
-#include <random>
 #include <filesystem>
-#include <iomanip>
-#include <ctime>
-#include <chrono>
 #include <cctype>
+#include <algorithm>
+#include <functional>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace fs = std::filesystem;
 
 namespace Banking {
 
+namespace {
+constexpr const char* JOURNAL_FAILED = "error: bank unavailable, transactions cannot be recorded";
+}
+
 std::string Bank::getAccountDir(const std::string& accountNumber) const {
     return dataDir + "/accounts/" + accountNumber;
 }
 
 std::string Bank::getStatementPath(const std::string& accountNumber) const {
-    return getAccountDir(accountNumber) + "/statement.csv";
+    return getAccountDir(accountNumber) + "/" + StatementFile::fileName(statementFormat);
 }
 
-std::string Bank::getPinPath(const std::string& accountNumber) const {
-    return getAccountDir(accountNumber) + "/pin.txt";
+StatementFile Bank::getStatementFile(const std::string& accountNumber) const {
+    return StatementFile(getStatementPath(accountNumber), statementFormat);
+}
+
+StatementFile& Bank::getMappedStatement(const std::string& accountNumber) {
+    auto& stripe = mappedStatements[lockStripe(accountNumber)];
+    auto it = stripe.statements.find(accountNumber);
+    if (it != stripe.statements.end()) {
+        stripe.lru.splice(stripe.lru.begin(), stripe.lru, it->second.lruPosition);
+        return it->second.file;
+    }
+    if (stripe.statements.size() >= MAPPED_STATEMENTS_PER_STRIPE) {
+        stripe.statements.erase(stripe.lru.back());
+        stripe.lru.pop_back();
+    }
+    stripe.lru.push_front(accountNumber);
+    auto inserted = stripe.statements.emplace(accountNumber,
+                                              MappedStatement{getStatementFile(accountNumber), stripe.lru.begin()});
+    return inserted.first->second.file;
 }
 
-std::string Bank::getSessionPath(const std::string& sessionId) const {
-    return dataDir + "/sessions/" + sessionId + ".txt";
+std::string Bank::getPinPath(const std::string& accountNumber) const {
+    return getAccountDir(accountNumber) + "/pin.txt";
 }
 
 std::string Bank::generateSessionId() {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(0, 15);
+    // 128 random bits, hex-encoded in one pass into a fixed buffer
     static const char* hex = "0123456789abcdef";
+    uint8_t token[SESSION_ID_BYTES];
+    secureRandomBytes(token, sizeof(token));
 
-    std::string sessionId;
-    for (int i = 0; i < 32; ++i) {
-        sessionId += hex[dis(gen)];
+    char text[2 * SESSION_ID_BYTES];
+    for (size_t i = 0; i < SESSION_ID_BYTES; ++i) {
+        text[2 * i] = hex[token[i] >> 4];
+        text[2 * i + 1] = hex[token[i] & 0xf];
     }
-    return sessionId;
-}
-
-std::string Bank::getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-    return ss.str();
+    return std::string(text, sizeof(text));
 }
 
 void Bank::ensureDirectories() {
@@ -55,43 +70,98 @@ void Bank::ensureDirectories() {
 }
 
 bool Bank::accountExists(const std::string& accountNumber) const {
-    return fs::exists(getAccountDir(accountNumber));
+    return accountIndex.contains(accountNumber);
 }
 
-std::string Bank::getStoredPin(const std::string& accountNumber) const {
+std::string Bank::loadStoredPin(const std::string& accountNumber) {
     std::ifstream file(getPinPath(accountNumber));
     if (!file.is_open()) return "";
-    std::string pin;
-    std::getline(file, pin);
-    return pin;
+    std::string stored;
+    std::getline(file, stored);
+    file.close();
+
+    // Pin files written before PINs were hashed hold the PIN itself
+    if (!CredentialStore::isHashed(stored)) {
+        stored = credentials.hashPin(stored);
+        writePinFile(accountNumber, stored);
+    }
+    return stored;
 }
 
-double Bank::getBalance(const std::string& accountNumber) const {
-    std::ifstream file(getStatementPath(accountNumber));
-    if (!file.is_open()) return 0.0;
+bool Bank::writePinFile(const std::string& accountNumber, const std::string& storedHash) const {
+    std::string path = getPinPath(accountNumber);
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::trunc);
+        file << storedHash;
+        if (!file.flush()) return false;
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    return !ec;
+}
 
-    std::string line;
-    double balance = 0.0;
-    while (std::getline(file, line)) {
-        // CSV format: timestamp,type,amount,balance
-        std::istringstream ss(line);
-        std::string timestamp, type, amountStr, balanceStr;
-        std::getline(ss, timestamp, ',');
-        std::getline(ss, type, ',');
-        std::getline(ss, amountStr, ',');
-        std::getline(ss, balanceStr, ',');
-        if (!balanceStr.empty()) {
-            try {
-                balance = std::stod(balanceStr);
-            } catch (...) {}
+Money Bank::getBalance(const std::string& accountNumber) const {
+    auto it = balances.find(accountNumber);
+    if (it == balances.end()) return Money();
+    return it->second;
+}
+
+// Whether amount can be added to the balance without passing MAX_BALANCE
+bool Bank::canCredit(const std::string& accountNumber, Money amount) const {
+    Money newBalance;
+    return Money::add(getBalance(accountNumber), amount, newBalance) && newBalance <= MAX_BALANCE;
+}
+
+Money Bank::readTailBalance(const std::string& accountNumber) const {
+    return getStatementFile(accountNumber).lastBalance();
+}
+
+void Bank::loadBalances() {
+    balances.clear();
+    customerAccounts.clear();
+    accountIndex.clear();
+    credentials.clear();
+    int64_t holdings = 0;
+    std::string accountsPath = dataDir + "/accounts";
+    for (const auto& entry : fs::directory_iterator(accountsPath)) {
+        if (entry.is_directory()) {
+            std::string accountNum = entry.path().filename().string();
+            Money balance = readTailBalance(accountNum);
+            balances[accountNum] = balance;
+            accountIndex.insert(accountNum);
+            credentials.set(accountNum, loadStoredPin(accountNum));
+            if (accountNum != ADMIN_ACCOUNT) {
+                customerAccounts.insert(accountNum);
+                holdings += balance.cents();
+            }
         }
     }
-    return balance;
+    totalHoldingsCents = holdings;
+}
+
+size_t Bank::lockStripe(const std::string& accountNumber) const {
+    return std::hash<std::string>{}(accountNumber) % LOCK_STRIPES;
 }
 
-void Bank::appendTransaction(const std::string& accountNumber, TransactionType type, double amount) {
-    double currentBalance = getBalance(accountNumber);
-    double newBalance = currentBalance;
+std::vector<std::unique_lock<std::mutex>> Bank::lockAccounts(std::vector<size_t> stripes) const {
+    // Ascending order with duplicates removed, so any two callers agree on
+    // the order and accounts sharing a stripe lock it once
+    std::sort(stripes.begin(), stripes.end());
+    stripes.erase(std::unique(stripes.begin(), stripes.end()), stripes.end());
+
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(stripes.size());
+    for (size_t stripe : stripes) {
+        locks.emplace_back(accountLocks[stripe]);
+    }
+    return locks;
+}
+
+Money Bank::appendTransaction(std::vector<JournalRecord>& records, const std::string& accountNumber,
+                              TransactionType type, Money amount) {
+    Money currentBalance = getBalance(accountNumber);
+    Money newBalance = currentBalance;
     
     if (type == TransactionType::DEPOSIT || type == TransactionType::TRANSFER_IN) {
         newBalance += amount;
@@ -99,65 +169,180 @@ void Bank::appendTransaction(const std::string& accountNumber, TransactionType t
         newBalance -= amount;
     }
 
-    std::string typeStr;
-    switch (type) {
-        case TransactionType::DEPOSIT: typeStr = "DEPOSIT"; break;
-        case TransactionType::DEBIT: typeStr = "DEBIT"; break;
-        case TransactionType::TRANSFER_IN: typeStr = "TRANSFER_IN"; break;
-        case TransactionType::TRANSFER_OUT: typeStr = "TRANSFER_OUT"; break;
-        case TransactionType::ACCOUNT_CREATED: typeStr = "ACCOUNT_CREATED"; break;
+    // timestamp,type,amount,balance
+    std::string line;
+    line.reserve(MAX_TIMESTAMP_LENGTH + 48);
+    appendCurrentTimestamp(line, timestampFormat);
+    line += ',';
+    line += transactionTypeName(type);
+    line += ',';
+    amount.appendTo(line);
+    line += ',';
+    newBalance.appendTo(line);
+
+    balances.find(accountNumber)->second = newBalance;
+    records.push_back({0, accountNumber, std::move(line)});
+
+    // The admin account is not part of the bank's holdings
+    if (accountNumber == ADMIN_ACCOUNT) {
+        return Money();
+    }
+    return newBalance - currentBalance;
+}
+
+bool Bank::commitTransactions(uint64_t sequence) {
+    return journal->waitDurable(sequence);
+}
+
+// Undo the balance and holdings changes of records whose commit failed.
+// They are undone as differences, not by restoring old values: anything
+// that ran on the same accounts after them was queued behind them and fails
+// too (a failed journal commits nothing more), so each caller undoes its own
+// records and the order does not matter.
+void Bank::revertTransactions(const std::vector<JournalRecord>& records) {
+    std::shared_lock<std::shared_mutex> lock(accountsMutex);
+    std::vector<size_t> stripes;
+    for (const auto& record : records) {
+        stripes.push_back(lockStripe(record.accountNumber));
+    }
+    auto accountLock = lockAccounts(std::move(stripes));
+
+    for (const auto& record : records) {
+        Transaction transaction;
+        if (!parseStatementLine(record.line, transaction)) continue;
+        Money change = transaction.amount;
+        if (transaction.type == TransactionType::DEBIT || transaction.type == TransactionType::TRANSFER_OUT) {
+            change = -change;
+        } else if (transaction.type != TransactionType::DEPOSIT &&
+                   transaction.type != TransactionType::TRANSFER_IN) {
+            continue;
+        }
+        balances.find(record.accountNumber)->second -= change;
+        if (record.accountNumber != ADMIN_ACCOUNT) {
+            totalHoldingsCents -= change.cents();
+        }
+    }
+}
+
+// Once a journal write has failed the balances in memory may be ahead of
+// what is on disk, so the bank refuses every operation until restarted
+bool Bank::journalFailed() const {
+    return journal->hasFailed();
+}
+
+void Bank::applyJournalRecords(const std::vector<JournalRecord>& records) {
+    // Group lines per account so each statement file is opened once per batch
+    std::unordered_map<std::string, std::vector<std::string>> linesByAccount;
+    for (const auto& record : records) {
+        linesByAccount[record.accountNumber].push_back(record.line);
+    }
+
+    for (const auto& [accountNumber, lines] : linesByAccount) {
+        std::lock_guard<std::mutex> lock(accountLocks[lockStripe(accountNumber)]);
+        getStatementFile(accountNumber).append(lines);
+        unsyncedStatements.insert(accountNumber);
     }
+}
 
-    std::ofstream file(getStatementPath(accountNumber), std::ios::app);
-    file << getCurrentTimestamp() << "," << typeStr << "," 
-         << std::fixed << std::setprecision(2) << amount << "," << newBalance << "\n";
+// fsync every statement appended to since the last call, so the journal can
+// checkpoint past the records they hold
+bool Bank::syncStatements() {
+    for (auto it = unsyncedStatements.begin(); it != unsyncedStatements.end();) {
+        int fd = open(getStatementPath(*it).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        bool synced = fsync(fd) == 0;
+        close(fd);
+        if (!synced) return false;
+        it = unsyncedStatements.erase(it);
+    }
+    return true;
 }
 
-Bank::Bank(const std::string& dataDirectory) : dataDir(dataDirectory) {
+void Bank::recoverStatements() {
+    std::vector<JournalRecord> records = journal->unappliedRecords();
+    if (records.empty()) return;
+
+    std::map<std::string, std::vector<std::string>> pendingLines;
+    for (const auto& record : records) {
+        pendingLines[record.accountNumber].push_back(record.line);
+    }
+
+    // Records after the checkpoint may already be partly applied: skip the
+    // longest run of them that the statement already ends with
+    for (auto& [accountNumber, lines] : pendingLines) {
+        StatementFile statement = getStatementFile(accountNumber);
+
+        // A torn last line can only be one of the pending records
+        statement.dropTornTail();
+        std::vector<std::string> existing = statement.tail(lines.size());
+        for (auto& line : lines) {
+            line = statement.canonicalLine(line);
+        }
+
+        size_t applied = 0;
+        for (size_t count = std::min(lines.size(), existing.size()); count > 0; --count) {
+            if (std::equal(lines.begin(), lines.begin() + count, existing.end() - count)) {
+                applied = count;
+                break;
+            }
+        }
+
+        statement.append(std::vector<std::string>(lines.begin() + static_cast<std::ptrdiff_t>(applied), lines.end()));
+        unsyncedStatements.insert(accountNumber);
+    }
+
+    if (syncStatements()) {
+        journal->setCheckpoint(records.back().sequence);
+    }
+}
+
+Bank::Bank(const std::string& dataDirectory, const SessionConfig& sessionConfig, StatementFormat statementFormat,
+           const TimestampFormat& timestampFormat, const CredentialConfig& credentialConfig)
+    : dataDir(dataDirectory), statementFormat(statementFormat), timestampFormat(timestampFormat), totalHoldingsCents(0),
+      credentials(credentialConfig), sessions(sessionConfig, dataDirectory + "/sessions/sessions.snapshot") {
     ensureDirectories();
+    convertAccountStatements(dataDir, statementFormat);
     
-    // Create admin account if it doesn't exist
-    if (!accountExists(ADMIN_ACCOUNT)) {
+    // Create admin account if it doesn't exist (the index is not built yet)
+    if (!fs::exists(getAccountDir(ADMIN_ACCOUNT))) {
         fs::create_directories(getAccountDir(ADMIN_ACCOUNT));
-        std::ofstream pinFile(getPinPath(ADMIN_ACCOUNT));
-        pinFile << ADMIN_PIN;
+        writePinFile(ADMIN_ACCOUNT, credentials.hashPin(ADMIN_PIN));
         std::ofstream statementFile(getStatementPath(ADMIN_ACCOUNT));
         // Admin account statement will show bank status
     }
+
+    journal = std::make_unique<Journal>(dataDir + "/journal.log", dataDir + "/journal.checkpoint");
+    recoverStatements();
+    loadBalances();
+    journal->start([this](const std::vector<JournalRecord>& records) {
+        applyJournalRecords(records);
+    }, [this] {
+        return syncStatements();
+    });
 }
 
 std::string Bank::login(const std::string& accountNumber, const std::string& pin) {
-    if (!accountExists(accountNumber)) {
+    if (journalFailed() || !accountExists(accountNumber)) {
         return "";
     }
     
-    std::string storedPin = getStoredPin(accountNumber);
-    if (storedPin != pin) {
+    // Runs on the credential store's verifier pool
+    if (!credentials.verify(accountNumber, pin)) {
         return "";
     }
 
     std::string sessionId = generateSessionId();
-    std::ofstream sessionFile(getSessionPath(sessionId));
-    sessionFile << accountNumber;
+    sessions.create(sessionId, accountNumber);
     
     return sessionId;
 }
 
 bool Bank::logout(const std::string& sessionId) {
-    std::string sessionPath = getSessionPath(sessionId);
-    if (fs::exists(sessionPath)) {
-        fs::remove(sessionPath);
-        return true;
-    }
-    return false;
+    return sessions.remove(sessionId);
 }
 
 std::string Bank::getAccountFromSession(const std::string& sessionId) const {
-    std::ifstream file(getSessionPath(sessionId));
-    if (!file.is_open()) return "";
-    std::string accountNumber;
-    std::getline(file, accountNumber);
-    return accountNumber;
+    return sessions.lookup(sessionId);
 }
 
 bool Bank::isAdmin(const std::string& sessionId) const {
@@ -165,6 +350,9 @@ bool Bank::isAdmin(const std::string& sessionId) const {
 }
 
 std::string Bank::createAccount(const std::string& sessionId, const std::string& accountNumber, const std::string& pin) {
+    if (journalFailed()) {
+        return JOURNAL_FAILED;
+    }
     if (!isAdmin(sessionId)) {
         return "error: unauthorized";
     }
@@ -191,57 +379,108 @@ std::string Bank::createAccount(const std::string& sessionId, const std::string&
         }
     }
     
-    if (accountExists(accountNumber)) {
-        return "error: account already exists";
-    }
+    // Hashed before taking the lock: it is deliberately slow
+    std::string storedHash = credentials.hashPin(pin);
+
+    uint64_t sequence;
+    {
+        std::unique_lock<std::shared_mutex> lock(accountsMutex);
+        if (accountExists(accountNumber)) {
+            return "error: account already exists";
+        }
 
-    fs::create_directories(getAccountDir(accountNumber));
-    std::ofstream pinFile(getPinPath(accountNumber));
-    pinFile << pin;
-    
-    // Create empty statement file
-    std::ofstream statementFile(getStatementPath(accountNumber));
-    appendTransaction(accountNumber, TransactionType::ACCOUNT_CREATED, 0);
+        fs::create_directories(getAccountDir(accountNumber));
+        writePinFile(accountNumber, storedHash);
+        credentials.set(accountNumber, storedHash);
+        
+        // Create empty statement file
+        std::ofstream statementFile(getStatementPath(accountNumber));
+        balances[accountNumber] = Money();
+        customerAccounts.insert(accountNumber);
+        accountIndex.insert(accountNumber);
+        
+        std::vector<JournalRecord> records;
+        appendTransaction(records, accountNumber, TransactionType::ACCOUNT_CREATED, Money());
+        sequence = journal->enqueue(records);
+    }
     
+    if (!commitTransactions(sequence)) {
+        return "error: transaction could not be recorded";
+    }
     return "ok";
 }
 
-std::string Bank::deposit(const std::string& sessionId, double amount) {
+std::string Bank::deposit(const std::string& sessionId, Money amount) {
+    if (journalFailed()) {
+        return JOURNAL_FAILED;
+    }
     std::string accountNumber = getAccountFromSession(sessionId);
     if (accountNumber.empty()) {
         return "error: invalid session";
     }
     
-    if (amount <= 0) {
+    if (amount <= Money()) {
         return "error: amount must be positive";
     }
 
-    appendTransaction(accountNumber, TransactionType::DEPOSIT, amount);
+    std::vector<JournalRecord> records;
+    uint64_t sequence;
+    {
+        std::shared_lock<std::shared_mutex> lock(accountsMutex);
+        auto accountLock = lockAccounts({lockStripe(accountNumber)});
+        if (!canCredit(accountNumber, amount)) {
+            return "error: balance limit exceeded";
+        }
+        
+        totalHoldingsCents += appendTransaction(records, accountNumber, TransactionType::DEPOSIT, amount).cents();
+        sequence = journal->enqueue(records);
+    }
     
+    if (!commitTransactions(sequence)) {
+        revertTransactions(records);
+        return "error: transaction could not be recorded";
+    }
     return "ok";
 }
 
-std::string Bank::debit(const std::string& sessionId, double amount) {
+std::string Bank::debit(const std::string& sessionId, Money amount) {
+    if (journalFailed()) {
+        return JOURNAL_FAILED;
+    }
     std::string accountNumber = getAccountFromSession(sessionId);
     if (accountNumber.empty()) {
         return "error: invalid session";
     }
     
-    if (amount <= 0) {
+    if (amount <= Money()) {
         return "error: amount must be positive";
     }
     
-    double balance = getBalance(accountNumber);
-    if (amount > balance) {
-        return "error: insufficient funds";
-    }
+    std::vector<JournalRecord> records;
+    uint64_t sequence;
+    {
+        std::shared_lock<std::shared_mutex> lock(accountsMutex);
+        auto accountLock = lockAccounts({lockStripe(accountNumber)});
+        Money balance = getBalance(accountNumber);
+        if (amount > balance) {
+            return "error: insufficient funds";
+        }
 
-    appendTransaction(accountNumber, TransactionType::DEBIT, amount);
+        totalHoldingsCents += appendTransaction(records, accountNumber, TransactionType::DEBIT, amount).cents();
+        sequence = journal->enqueue(records);
+    }
     
+    if (!commitTransactions(sequence)) {
+        revertTransactions(records);
+        return "error: transaction could not be recorded";
+    }
     return "ok";
 }
 
 std::string Bank::getStatement(const std::string& sessionId, int lines) {
+    if (journalFailed()) {
+        return JOURNAL_FAILED;
+    }
     std::string accountNumber = getAccountFromSession(sessionId);
     if (accountNumber.empty()) {
         return "error: invalid session";
@@ -252,73 +491,160 @@ std::string Bank::getStatement(const std::string& sessionId, int lines) {
         return getBankStatus();
     }
 
-    std::ifstream file(getStatementPath(accountNumber));
-    if (!file.is_open()) {
+    std::string result = "timestamp,type,amount,balance\n";
+    std::lock_guard<std::mutex> lock(accountLocks[lockStripe(accountNumber)]);
+    bool readable = getMappedStatement(accountNumber).visitTail(
+        static_cast<size_t>(std::max(0, lines)), [&](std::string_view line) {
+            result.append(line);
+            result += '\n';
+        });
+    if (!readable) {
         return "error: no statement found";
     }
+    
+    return result;
+}
 
-    std::vector<std::string> allLines;
-    std::string line;
-    while (std::getline(file, line)) {
-        allLines.push_back(line);
+std::string Bank::getTransactions(const std::string& sessionId, std::vector<Transaction>& transactions,
+                                  uint64_t& next, uint64_t before, size_t limit) {
+    transactions.clear();
+    next = 0;
+    if (journalFailed()) {
+        return JOURNAL_FAILED;
+    }
+    std::string accountNumber = getAccountFromSession(sessionId);
+    if (accountNumber.empty()) {
+        return "error: invalid session";
+    }
+    if (limit == 0) {
+        return "error: limit must be positive";
+    }
+    limit = std::min(limit, MAX_STATEMENT_PAGE_SIZE);
+
+    std::lock_guard<std::mutex> lock(accountLocks[lockStripe(accountNumber)]);
+    bool parsed = true;
+    bool readable = getMappedStatement(accountNumber).visitBefore(
+        before, limit, [&](uint64_t sequence, std::string_view line) {
+            Transaction transaction;
+            if (!parseStatementLine(line, transaction)) {
+                parsed = false;
+                return;
+            }
+            transaction.sequence = sequence;
+            transactions.push_back(std::move(transaction));
+        });
+    if (!readable) {
+        return "error: no statement found";
+    }
+    if (!parsed) {
+        return "error: statement is corrupt";
     }
 
-    std::stringstream result;
-    result << "timestamp,type,amount,balance\n";
-    
-    int startIdx = std::max(0, static_cast<int>(allLines.size()) - lines);
-    for (int i = startIdx; i < static_cast<int>(allLines.size()); ++i) {
-        result << allLines[i] << "\n";
+    if (!transactions.empty()) {
+        next = transactions.front().sequence;
     }
-    
+    return "ok";
+}
+
+std::string Bank::getHoldingsSummary() const {
+    size_t accountCount;
+    {
+        std::shared_lock<std::shared_mutex> lock(accountsMutex);
+        accountCount = customerAccounts.size();
+    }
+
+    std::stringstream result;
+    result << "Total Accounts: " << accountCount << "\n";
+    result << "Total Holdings: " << Money::fromCents(totalHoldingsCents.load()) << "\n";
     return result.str();
 }
 
 std::string Bank::getBankStatus() {
+    if (journalFailed()) {
+        return JOURNAL_FAILED;
+    }
     std::stringstream result;
     result << "Bank Status Report\n";
     result << "==================\n";
+    result << getHoldingsSummary();
     
-    double totalHoldings = 0.0;
-    int accountCount = 0;
+    return result.str();
+}
+
+std::string Bank::listAccounts(const std::string& sessionId, const std::string& after, size_t limit) {
+    if (journalFailed()) {
+        return JOURNAL_FAILED;
+    }
+    if (!isAdmin(sessionId)) {
+        return "error: unauthorized";
+    }
+    if (limit == 0) {
+        return "error: limit must be positive";
+    }
+    limit = std::min(limit, MAX_ACCOUNTS_PAGE_SIZE);
+
+    std::stringstream result;
+    result << "Bank Status Report\n";
+    result << "==================\n";
     
-    std::string accountsPath = dataDir + "/accounts";
-    if (fs::exists(accountsPath)) {
-        for (const auto& entry : fs::directory_iterator(accountsPath)) {
-            if (entry.is_directory()) {
-                std::string accountNum = entry.path().filename().string();
-                if (accountNum != ADMIN_ACCOUNT) {
-                    double balance = getBalance(accountNum);
-                    result << "Account " << accountNum << ": " 
-                           << std::fixed << std::setprecision(2) << balance << "\n";
-                    totalHoldings += balance;
-                    accountCount++;
-                }
-            }
+    std::string next;
+    {
+        std::shared_lock<std::shared_mutex> lock(accountsMutex);
+        std::vector<std::string> page;
+        std::vector<size_t> stripes;
+        auto it = customerAccounts.upper_bound(after);
+        for (; it != customerAccounts.end() && page.size() < limit; ++it) {
+            page.push_back(*it);
+            stripes.push_back(lockStripe(*it));
+        }
+        if (it != customerAccounts.end()) {
+            next = page.back();
+        }
+
+        auto accountLock = lockAccounts(stripes);
+        for (const std::string& accountNum : page) {
+            result << "Account " << accountNum << ": " << getBalance(accountNum) << "\n";
         }
     }
-    
+
     result << "==================\n";
-    result << "Total Accounts: " << accountCount << "\n";
-    result << "Total Holdings: " << std::fixed << std::setprecision(2) << totalHoldings << "\n";
-    
+    result << getHoldingsSummary();
+    if (!next.empty()) {
+        result << "Next: " << next << "\n";
+    }
     return result.str();
 }
 
-std::string Bank::listAccounts(const std::string& sessionId) {
+std::string Bank::getSessionStats(const std::string& sessionId) {
+    if (journalFailed()) {
+        return JOURNAL_FAILED;
+    }
     if (!isAdmin(sessionId)) {
         return "error: unauthorized";
     }
-    return getBankStatus();
+
+    SessionStats stats = sessions.getStats();
+    std::stringstream result;
+    result << "Session Stats\n";
+    result << "=============\n";
+    result << "Live: " << stats.live << "\n";
+    result << "Created: " << stats.created << "\n";
+    result << "Expired: " << stats.expired << "\n";
+    result << "Evicted: " << stats.evicted << "\n";
+    result << "Logged Out: " << stats.loggedOut << "\n";
+    return result.str();
 }
 
-std::string Bank::transfer(const std::string& sessionId, const std::string& toAccountNumber, double amount) {
+std::string Bank::transfer(const std::string& sessionId, const std::string& toAccountNumber, Money amount) {
+    if (journalFailed()) {
+        return JOURNAL_FAILED;
+    }
     std::string fromAccountNumber = getAccountFromSession(sessionId);
     if (fromAccountNumber.empty()) {
         return "error: invalid session";
     }
     
-    if (amount <= 0) {
+    if (amount <= Money()) {
         return "error: amount must be positive";
     }
     
@@ -330,17 +656,139 @@ std::string Bank::transfer(const std::string& sessionId, const std::string& toAc
         return "error: cannot transfer to same account";
     }
     
-    double balance = getBalance(fromAccountNumber);
-    if (amount > balance) {
-        return "error: insufficient funds";
-    }
+    std::vector<JournalRecord> records;
+    uint64_t sequence;
+    {
+        // Indexed accounts always have a balance: createAccount adds the
+        // balance first, under the exclusive lock
+        std::shared_lock<std::shared_mutex> lock(accountsMutex);
+        auto accountLock = lockAccounts({lockStripe(fromAccountNumber), lockStripe(toAccountNumber)});
+        Money balance = getBalance(fromAccountNumber);
+        if (amount > balance) {
+            return "error: insufficient funds";
+        }
+        if (!canCredit(toAccountNumber, amount)) {
+            return "error: balance limit exceeded";
+        }
 
-    // Debit from source account
-    appendTransaction(fromAccountNumber, TransactionType::TRANSFER_OUT, amount);
-    
-    // Credit to destination account
-    appendTransaction(toAccountNumber, TransactionType::TRANSFER_IN, amount);
+        // Both legs go to the journal as one group, so they commit together
+        // Applied once, so the status summary never sees half a transfer
+        Money holdingsChange = appendTransaction(records, fromAccountNumber, TransactionType::TRANSFER_OUT, amount);
+        holdingsChange += appendTransaction(records, toAccountNumber, TransactionType::TRANSFER_IN, amount);
+        if (holdingsChange != Money()) {
+            totalHoldingsCents += holdingsChange.cents();
+        }
+        sequence = journal->enqueue(records);
+    }
     
+    if (!commitTransactions(sequence)) {
+        revertTransactions(records);
+        return "error: transaction could not be recorded";
+    }
+    return "ok";
+}
+
+std::string Bank::applyBatchOperation(std::vector<JournalRecord>& records, const std::string& accountNumber,
+                                      const BatchOperation& operation, Money& holdingsChange) {
+    if (operation.amount <= Money()) {
+        return "error: amount must be positive";
+    }
+
+    switch (operation.type) {
+        case TransactionType::DEPOSIT:
+            if (!canCredit(accountNumber, operation.amount)) {
+                return "error: balance limit exceeded";
+            }
+            holdingsChange += appendTransaction(records, accountNumber, TransactionType::DEPOSIT, operation.amount);
+            return "ok";
+
+        case TransactionType::DEBIT:
+            if (operation.amount > getBalance(accountNumber)) {
+                return "error: insufficient funds";
+            }
+            holdingsChange += appendTransaction(records, accountNumber, TransactionType::DEBIT, operation.amount);
+            return "ok";
+
+        case TransactionType::TRANSFER_OUT:
+            if (!accountExists(operation.toAccountNumber)) {
+                return "error: destination account does not exist";
+            }
+            if (operation.toAccountNumber == accountNumber) {
+                return "error: cannot transfer to same account";
+            }
+            if (operation.amount > getBalance(accountNumber)) {
+                return "error: insufficient funds";
+            }
+            if (!canCredit(operation.toAccountNumber, operation.amount)) {
+                return "error: balance limit exceeded";
+            }
+            holdingsChange += appendTransaction(records, accountNumber, TransactionType::TRANSFER_OUT, operation.amount);
+            holdingsChange += appendTransaction(records, operation.toAccountNumber, TransactionType::TRANSFER_IN,
+                                                operation.amount);
+            return "ok";
+
+        default:
+            return "error: unsupported operation";
+    }
+}
+
+std::string Bank::applyBatch(const std::string& sessionId, const std::vector<BatchOperation>& operations,
+                             std::vector<std::string>& results) {
+    results.clear();
+    if (journalFailed()) {
+        return JOURNAL_FAILED;
+    }
+    std::string accountNumber = getAccountFromSession(sessionId);
+    if (accountNumber.empty()) {
+        return "error: invalid session";
+    }
+
+    if (operations.empty()) {
+        return "error: empty batch";
+    }
+
+    if (operations.size() > MAX_BATCH_OPERATIONS) {
+        return "error: batch too large";
+    }
+
+    results.reserve(operations.size());
+    std::vector<JournalRecord> records;
+    uint64_t sequence;
+    {
+        std::shared_lock<std::shared_mutex> lock(accountsMutex);
+
+        // Every account the batch can touch, locked once for all of it
+        std::vector<size_t> stripes = {lockStripe(accountNumber)};
+        for (const auto& operation : operations) {
+            if (operation.type == TransactionType::TRANSFER_OUT && accountExists(operation.toAccountNumber)) {
+                stripes.push_back(lockStripe(operation.toAccountNumber));
+            }
+        }
+        auto accountLock = lockAccounts(std::move(stripes));
+
+        // Operations see the balances left by the ones before them
+        Money holdingsChange;
+        for (const auto& operation : operations) {
+            results.push_back(applyBatchOperation(records, accountNumber, operation, holdingsChange));
+        }
+        if (holdingsChange != Money()) {
+            totalHoldingsCents += holdingsChange.cents();
+        }
+        if (records.empty()) {
+            return "ok";
+        }
+        sequence = journal->enqueue(records);
+    }
+
+    if (!commitTransactions(sequence)) {
+        revertTransactions(records);
+        for (auto& result : results) {
+            if (result == "ok") {
+                result = "error: transaction could not be recorded";
+            }
+        }
+        return "error: transaction could not be recorded";
+    }
     return "ok";
 }
 
@@ -2,31 +2,126 @@
 #define BANK_H
 
 #include <string>
+#include <list>
 #include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <array>
 #include <vector>
+#include <memory>
+#include <cstdint>
+#include "AccountIndex.h"
 #include "Constants.h"
+#include "CredentialStore.h"
+#include "Money.h"
 #include "Transaction.h"
+#include "Journal.h"
+#include "SessionStore.h"
+#include "StatementFile.h"
+#include "Timestamp.h"
 
 namespace Banking {
 
 class Bank {
 private:
     std::string dataDir;
+    StatementFormat statementFormat;
+    TimestampFormat timestampFormat;
+
+    // Current balance per account, loaded from each statement's last line at
+    // startup and kept up to date by appendTransaction
+    std::unordered_map<std::string, Money> balances;
+
+    // Customer accounts in order, for the paginated listing, and the sum of
+    // their balances in cents, kept current by every transaction so the bank
+    // status summary never has to visit the accounts
+    std::set<std::string> customerAccounts;
+    std::atomic<int64_t> totalHoldingsCents;
+
+    // Every account number, admin included: existence checks are a bitmap
+    // lookup that takes no lock and never touches the filesystem
+    AccountIndex accountIndex;
+
+    // Salted PIN hashes, loaded at startup so login never reads pin.txt
+    CredentialStore credentials;
+
+    // Lock order: accountsMutex first (exclusive only to add accounts), then
+    // account stripes in ascending index order. A stripe guards the balance
+    // and statement file of every account that hashes to it.
+    static constexpr size_t LOCK_STRIPES = 64;
+    mutable std::shared_mutex accountsMutex;
+    mutable std::array<std::mutex, LOCK_STRIPES> accountLocks;
+
+    // Statements kept mapped for the read paths, per stripe and guarded by
+    // it; bounded so a scan over many accounts does not pin a mapping each.
+    // The least recently read statement is unmapped first.
+    static constexpr size_t MAPPED_STATEMENTS_PER_STRIPE = 16;
+    struct MappedStatement {
+        StatementFile file;
+        std::list<std::string>::iterator lruPosition;
+    };
+    struct MappedStripe {
+        std::unordered_map<std::string, MappedStatement> statements;
+        std::list<std::string> lru;     // most recently read first
+    };
+    std::array<MappedStripe, LOCK_STRIPES> mappedStatements;
+
+    // Live sessions, held in memory (optionally snapshotted to disk).
+    // Mutable because a lookup refreshes the session's idle timer.
+    mutable SessionStore sessions;
+
+    // Accounts whose statements were appended to since they were last
+    // synced; used by recovery and then only by the journal's commit thread
+    std::unordered_set<std::string> unsyncedStatements;
+
+    // Session ids are this many random bytes, hex-encoded
+    static constexpr size_t SESSION_ID_BYTES = 16;
 
     std::string getAccountDir(const std::string& accountNumber) const;
     std::string getStatementPath(const std::string& accountNumber) const;
+    StatementFile getStatementFile(const std::string& accountNumber) const;
+    StatementFile& getMappedStatement(const std::string& accountNumber);
     std::string getPinPath(const std::string& accountNumber) const;
-    std::string getSessionPath(const std::string& sessionId) const;
     std::string generateSessionId();
-    std::string getCurrentTimestamp();
     void ensureDirectories();
     bool accountExists(const std::string& accountNumber) const;
-    std::string getStoredPin(const std::string& accountNumber) const;
-    double getBalance(const std::string& accountNumber) const;
-    void appendTransaction(const std::string& accountNumber, TransactionType type, double amount);
+    std::string loadStoredPin(const std::string& accountNumber);
+    bool writePinFile(const std::string& accountNumber, const std::string& storedHash) const;
+    Money getBalance(const std::string& accountNumber) const;
+    bool canCredit(const std::string& accountNumber, Money amount) const;
+    Money readTailBalance(const std::string& accountNumber) const;
+    void loadBalances();
+    size_t lockStripe(const std::string& accountNumber) const;
+    std::vector<std::unique_lock<std::mutex>> lockAccounts(std::vector<size_t> stripes) const;
+    // Returns the change in total holdings
+    Money appendTransaction(std::vector<JournalRecord>& records, const std::string& accountNumber,
+                            TransactionType type, Money amount);
+    std::string applyBatchOperation(std::vector<JournalRecord>& records, const std::string& accountNumber,
+                                    const BatchOperation& operation, Money& holdingsChange);
+    bool commitTransactions(uint64_t sequence);
+    void revertTransactions(const std::vector<JournalRecord>& records);
+    bool journalFailed() const;
+    std::string getHoldingsSummary() const;
+    void applyJournalRecords(const std::vector<JournalRecord>& records);
+    bool syncStatements();
+    void recoverStatements();
+
+    // Write-ahead log; statement.csv files are derived from it. Declared last
+    // so its commit thread stops before the state it applies to is destroyed
+    std::unique_ptr<Journal> journal;
 
 public:
-    explicit Bank(const std::string& dataDirectory = DATA_DIR);
+    // Statements left in the other format, and PINs still stored in plain
+    // text, are converted at startup
+    explicit Bank(const std::string& dataDirectory = DATA_DIR,
+                  const SessionConfig& sessionConfig = SessionConfig(),
+                  StatementFormat statementFormat = StatementFormat::Csv,
+                  const TimestampFormat& timestampFormat = TimestampFormat(),
+                  const CredentialConfig& credentialConfig = CredentialConfig());
 
     // Login: returns session_id or empty string on failure
     std::string login(const std::string& accountNumber, const std::string& pin);
@@ -44,22 +139,43 @@ public:
     std::string createAccount(const std::string& sessionId, const std::string& accountNumber, const std::string& pin);
 
     // Deposit (customer)
-    std::string deposit(const std::string& sessionId, double amount);
+    std::string deposit(const std::string& sessionId, Money amount);
 
     // Debit (customer)
-    std::string debit(const std::string& sessionId, double amount);
+    std::string debit(const std::string& sessionId, Money amount);
 
     // Statement (customer)
     std::string getStatement(const std::string& sessionId, int lines = 10);
 
-    // Get bank status (admin only) - lists all accounts and total holdings
+    // One page of the statement as typed records, oldest first: up to limit
+    // (at most MAX_STATEMENT_PAGE_SIZE) transactions numbered below before (the newest ones when before is
+    // omitted). next gets the cursor for the page before this one, or 0 when
+    // this page starts at the first transaction.
+    std::string getTransactions(const std::string& sessionId, std::vector<Transaction>& transactions,
+                                uint64_t& next, uint64_t before = UINT64_MAX,
+                                size_t limit = STATEMENT_PAGE_SIZE);
+
+    // Get bank status (admin only) - account count and total holdings
     std::string getBankStatus();
 
-    // List accounts (admin only)
-    std::string listAccounts(const std::string& sessionId);
+    // List accounts (admin only) - up to limit (at most MAX_ACCOUNTS_PAGE_SIZE)
+    // accounts numbered after 'after', followed by the bank status; ends with
+    // "Next: <account>" when more accounts follow
+    std::string listAccounts(const std::string& sessionId, const std::string& after = "",
+                             size_t limit = ACCOUNTS_PAGE_SIZE);
+
+    // Session counters: live, created, expired, evicted, logged out (admin only)
+    std::string getSessionStats(const std::string& sessionId);
 
     // Transfer money between accounts (customer)
-    std::string transfer(const std::string& sessionId, const std::string& toAccountNumber, double amount);
+    std::string transfer(const std::string& sessionId, const std::string& toAccountNumber, Money amount);
+
+    // Apply up to MAX_BATCH_OPERATIONS deposits, debits and transfers from the
+    // session's account, in order, under one acquisition of the account locks
+    // and as one journal transaction. results gets "ok" or an error for each
+    // operation; the return value is "ok" or an error for the whole batch.
+    std::string applyBatch(const std::string& sessionId, const std::vector<BatchOperation>& operations,
+                           std::vector<std::string>& results);
 };
 
 } // namespace Banking
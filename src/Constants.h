@@ -1,6 +1,8 @@
 #ifndef CONSTANTS_H
 #define CONSTANTS_H
 
+#include <cstddef>
+
 namespace Banking {
 
 // Admin account credentials
@@ -12,6 +14,19 @@ constexpr const char* DATA_DIR = "data";
 constexpr const char* ACCOUNTS_DIR = "data/accounts";
 constexpr const char* SESSIONS_DIR = "data/sessions";
 
+// Accounts per page of the admin account listing, and the most a caller
+// may ask for; larger limits are clamped to it
+constexpr size_t ACCOUNTS_PAGE_SIZE = 50;
+constexpr size_t MAX_ACCOUNTS_PAGE_SIZE = ACCOUNTS_PAGE_SIZE * 10;
+
+// Transactions per page of the statement endpoint, and the most a caller
+// may ask for; larger limits are clamped to it
+constexpr size_t STATEMENT_PAGE_SIZE = 50;
+constexpr size_t MAX_STATEMENT_PAGE_SIZE = STATEMENT_PAGE_SIZE * 10;
+
+// Most operations accepted in one Bank::applyBatch call
+constexpr size_t MAX_BATCH_OPERATIONS = 1000;
+
 } // namespace Banking
 
 #endif // CONSTANTS_H
@@ -0,0 +1,289 @@
+#include "CredentialStore.h"
+#include "SecureRandom.h"
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+#include <string_view>
+
+namespace Banking {
+
+namespace {
+constexpr const char* HASH_SCHEME = "pbkdf2-sha256$";
+constexpr size_t SALT_BYTES = 16;
+constexpr size_t DIGEST_BYTES = 32;
+
+// SHA-256 (FIPS 180-4), just enough for HMAC and PBKDF2
+class Sha256 {
+public:
+    Sha256() : state_{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19} {}
+
+    void update(const uint8_t* data, size_t size) {
+        length_ += size;
+        while (size > 0) {
+            size_t take = std::min(size, sizeof(buffer_) - used_);
+            std::memcpy(buffer_ + used_, data, take);
+            used_ += take;
+            data += take;
+            size -= take;
+            if (used_ == sizeof(buffer_)) {
+                compress(buffer_);
+                used_ = 0;
+            }
+        }
+    }
+
+    void finish(uint8_t digest[DIGEST_BYTES]) {
+        uint64_t bits = length_ * 8;
+        uint8_t padding[72] = {0x80};
+        size_t padLength = (used_ < 56 ? 56 : 120) - used_;
+        for (int i = 0; i < 8; ++i) {
+            padding[padLength + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+        }
+        update(padding, padLength + 8);
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                digest[4 * i + j] = static_cast<uint8_t>(state_[i] >> (24 - 8 * j));
+            }
+        }
+    }
+
+private:
+    uint32_t state_[8];
+    uint8_t buffer_[64] = {};
+    size_t used_ = 0;
+    uint64_t length_ = 0;
+
+    static uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+    void compress(const uint8_t block[64]) {
+        static constexpr uint32_t K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+        };
+
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (uint32_t{block[4 * i]} << 24) | (uint32_t{block[4 * i + 1]} << 16) |
+                   (uint32_t{block[4 * i + 2]} << 8) | uint32_t{block[4 * i + 3]};
+        }
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+        uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state_[0] += a; state_[1] += b; state_[2] += c; state_[3] += d;
+        state_[4] += e; state_[5] += f; state_[6] += g; state_[7] += h;
+    }
+};
+
+// PBKDF2-HMAC-SHA256 with a single 32-byte output block. The HMAC key
+// schedule is absorbed once and copied for every iteration.
+void pbkdf2(const std::string& pin, const uint8_t* salt, size_t saltLength, uint32_t iterations,
+            uint8_t out[DIGEST_BYTES]) {
+    uint8_t key[64] = {};
+    if (pin.size() > sizeof(key)) {
+        Sha256 keyHash;
+        keyHash.update(reinterpret_cast<const uint8_t*>(pin.data()), pin.size());
+        keyHash.finish(key);
+    } else {
+        std::memcpy(key, pin.data(), pin.size());
+    }
+    uint8_t innerPad[64];
+    uint8_t outerPad[64];
+    for (size_t i = 0; i < 64; ++i) {
+        innerPad[i] = key[i] ^ 0x36;
+        outerPad[i] = key[i] ^ 0x5c;
+    }
+    Sha256 inner;
+    inner.update(innerPad, sizeof(innerPad));
+    Sha256 outer;
+    outer.update(outerPad, sizeof(outerPad));
+
+    auto hmac = [&](const uint8_t* message, size_t length, uint8_t digest[DIGEST_BYTES]) {
+        Sha256 innerHash = inner;
+        innerHash.update(message, length);
+        innerHash.finish(digest);
+        Sha256 outerHash = outer;
+        outerHash.update(digest, DIGEST_BYTES);
+        outerHash.finish(digest);
+    };
+
+    // U1 = HMAC(pin, salt || INT(1)), Un = HMAC(pin, Un-1), out = U1 ^ ... ^ Uc
+    std::vector<uint8_t> first(salt, salt + saltLength);
+    first.insert(first.end(), {0, 0, 0, 1});
+    uint8_t block[DIGEST_BYTES];
+    hmac(first.data(), first.size(), block);
+    std::memcpy(out, block, DIGEST_BYTES);
+    for (uint32_t i = 1; i < iterations; ++i) {
+        hmac(block, DIGEST_BYTES, block);
+        for (size_t j = 0; j < DIGEST_BYTES; ++j) {
+            out[j] ^= block[j];
+        }
+    }
+}
+
+void appendHex(std::string& out, const uint8_t* bytes, size_t length) {
+    static const char* hex = "0123456789abcdef";
+    for (size_t i = 0; i < length; ++i) {
+        out += hex[bytes[i] >> 4];
+        out += hex[bytes[i] & 0xf];
+    }
+}
+
+bool parseHex(std::string_view text, std::vector<uint8_t>& bytes) {
+    if (text.size() % 2 != 0) return false;
+    bytes.clear();
+    for (size_t i = 0; i < text.size(); i += 2) {
+        uint8_t byte;
+        auto [end, ec] = std::from_chars(text.data() + i, text.data() + i + 2, byte, 16);
+        if (ec != std::errc() || end != text.data() + i + 2) return false;
+        bytes.push_back(byte);
+    }
+    return true;
+}
+}
+
+CredentialStore::CredentialStore(const CredentialConfig& config)
+    : config_(config), outstanding_(0), stopping_(false) {
+    size_t threads = std::max<size_t>(1, config_.verifyThreads);
+    for (size_t i = 0; i < threads; ++i) {
+        verifiers_.emplace_back(&CredentialStore::verifierLoop, this);
+    }
+}
+
+CredentialStore::~CredentialStore() {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        stopping_ = true;
+    }
+    pendingCv_.notify_all();
+    for (auto& verifier : verifiers_) {
+        verifier.join();
+    }
+}
+
+std::string CredentialStore::hashPin(const std::string& pin) const {
+    uint8_t salt[SALT_BYTES];
+    secureRandomBytes(salt, SALT_BYTES);
+
+    uint32_t iterations = std::max<uint32_t>(1, config_.workFactor);
+    uint8_t digest[DIGEST_BYTES];
+    pbkdf2(pin, salt, SALT_BYTES, iterations, digest);
+
+    std::string stored = HASH_SCHEME;
+    stored += std::to_string(iterations);
+    stored += '$';
+    appendHex(stored, salt, SALT_BYTES);
+    stored += '$';
+    appendHex(stored, digest, DIGEST_BYTES);
+    return stored;
+}
+
+bool CredentialStore::isHashed(const std::string& stored) {
+    return stored.rfind(HASH_SCHEME, 0) == 0;
+}
+
+bool CredentialStore::matches(const std::string& storedHash, const std::string& pin) {
+    if (!isHashed(storedHash)) return false;
+
+    // <iterations>$<salt hex>$<hash hex>
+    std::string_view rest(storedHash);
+    rest.remove_prefix(std::strlen(HASH_SCHEME));
+    size_t saltStart = rest.find('$');
+    if (saltStart == std::string_view::npos) return false;
+    size_t hashStart = rest.find('$', saltStart + 1);
+    if (hashStart == std::string_view::npos) return false;
+
+    uint32_t iterations = 0;
+    auto [end, ec] = std::from_chars(rest.data(), rest.data() + saltStart, iterations);
+    std::vector<uint8_t> salt;
+    std::vector<uint8_t> expected;
+    if (ec != std::errc() || end != rest.data() + saltStart || iterations == 0 ||
+        !parseHex(rest.substr(saltStart + 1, hashStart - saltStart - 1), salt) ||
+        !parseHex(rest.substr(hashStart + 1), expected) || expected.size() != DIGEST_BYTES) {
+        return false;
+    }
+
+    uint8_t digest[DIGEST_BYTES];
+    pbkdf2(pin, salt.data(), salt.size(), iterations, digest);
+
+    // Constant time: every byte is compared whatever the first mismatch
+    uint8_t difference = 0;
+    for (size_t i = 0; i < DIGEST_BYTES; ++i) {
+        difference |= static_cast<uint8_t>(digest[i] ^ expected[i]);
+    }
+    return difference == 0;
+}
+
+void CredentialStore::set(const std::string& accountNumber, const std::string& storedHash) {
+    std::unique_lock<std::shared_mutex> lock(hashesMutex_);
+    hashes_[accountNumber] = storedHash;
+}
+
+void CredentialStore::clear() {
+    std::unique_lock<std::shared_mutex> lock(hashesMutex_);
+    hashes_.clear();
+}
+
+bool CredentialStore::verify(const std::string& accountNumber, const std::string& pin) {
+    Verification verification;
+    {
+        std::shared_lock<std::shared_mutex> lock(hashesMutex_);
+        auto it = hashes_.find(accountNumber);
+        if (it == hashes_.end()) return false;
+        verification.storedHash = it->second;
+    }
+    verification.pin = pin;
+    std::future<bool> result = verification.result.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        if (stopping_ || outstanding_ >= config_.maxPendingVerifications) {
+            return false;
+        }
+        pending_.push_back(std::move(verification));
+        ++outstanding_;
+    }
+    pendingCv_.notify_one();
+    return result.get();
+}
+
+void CredentialStore::verifierLoop() {
+    std::unique_lock<std::mutex> lock(pendingMutex_);
+    while (true) {
+        pendingCv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) break;
+
+        Verification verification = std::move(pending_.front());
+        pending_.pop_front();
+        lock.unlock();
+        bool matched = matches(verification.storedHash, verification.pin);
+        lock.lock();
+        --outstanding_;
+        verification.result.set_value(matched);
+    }
+}
+
+} // namespace Banking
@@ -0,0 +1,82 @@
+#ifndef CREDENTIAL_STORE_H
+#define CREDENTIAL_STORE_H
+
+#include <string>
+#include <unordered_map>
+#include <deque>
+#include <vector>
+#include <future>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <condition_variable>
+
+namespace Banking {
+
+struct CredentialConfig {
+    // PBKDF2-HMAC-SHA256 iterations for newly hashed PINs. Existing hashes
+    // keep the count they were created with.
+    uint32_t workFactor = 20000;
+
+    // Threads that verify PINs at login, and how many logins may be in the
+    // pool at once, queued or being verified; logins beyond that fail at
+    // once instead of queueing. Each of them holds its caller's thread, so a
+    // server keeps this below its worker count (default: 2 * verifyThreads).
+    size_t verifyThreads = 2;
+    size_t maxPendingVerifications = 4;
+};
+
+// In-memory table of salted PIN hashes: account number -> stored hash text
+//   pbkdf2-sha256$<iterations>$<salt hex>$<hash hex>
+// Logins are verified on a small dedicated pool of threads, so a burst of
+// logins costs at most verifyThreads cores and cannot starve the threads
+// that process transactions.
+class CredentialStore {
+public:
+    explicit CredentialStore(const CredentialConfig& config);
+    ~CredentialStore();
+
+    CredentialStore(const CredentialStore&) = delete;
+    CredentialStore& operator=(const CredentialStore&) = delete;
+
+    // Stored hash text for a PIN, with a fresh salt and the configured work factor
+    std::string hashPin(const std::string& pin) const;
+
+    // Whether stored text is a hash (older pin files hold the PIN itself)
+    static bool isHashed(const std::string& stored);
+
+    void set(const std::string& accountNumber, const std::string& storedHash);
+    void clear();
+
+    // False for an unknown account, a wrong PIN, or when the pool is full
+    bool verify(const std::string& accountNumber, const std::string& pin);
+
+    // Check a PIN against stored hash text on the calling thread
+    static bool matches(const std::string& storedHash, const std::string& pin);
+
+private:
+    struct Verification {
+        std::string storedHash;
+        std::string pin;
+        std::promise<bool> result;
+    };
+
+    CredentialConfig config_;
+
+    std::unordered_map<std::string, std::string> hashes_;
+    mutable std::shared_mutex hashesMutex_;
+
+    std::deque<Verification> pending_;
+    size_t outstanding_;        // queued plus being verified
+    std::mutex pendingMutex_;
+    std::condition_variable pendingCv_;
+    bool stopping_;
+    std::vector<std::thread> verifiers_;
+
+    void verifierLoop();
+};
+
+} // namespace Banking
+
+#endif // CREDENTIAL_STORE_H
@@ -0,0 +1,30 @@
+#ifndef HTTP_TEXT_H
+#define HTTP_TEXT_H
+
+#include <string_view>
+
+namespace Banking {
+
+// Header text helpers shared by WebServer and StaticAsset
+
+// Without the spaces and tabs HTTP allows around a header value
+inline std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+    return text;
+}
+
+// ASCII case-insensitive comparison, as for header names and tokens
+inline bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i] >= 'A' && a[i] <= 'Z' ? static_cast<char>(a[i] + 32) : a[i];
+        char y = b[i] >= 'A' && b[i] <= 'Z' ? static_cast<char>(b[i] + 32) : b[i];
+        if (x != y) return false;
+    }
+    return true;
+}
+
+} // namespace Banking
+
+#endif // HTTP_TEXT_H
@@ -0,0 +1,365 @@
+#include "Journal.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <algorithm>
+#include <filesystem>
+
+namespace Banking {
+
+namespace {
+// Parse "sequence[+],account,line"; false for anything else
+bool parseRecord(std::string_view text, JournalRecord& record) {
+    size_t firstComma = text.find(',');
+    if (firstComma == std::string_view::npos || firstComma == 0) return false;
+    size_t secondComma = text.find(',', firstComma + 1);
+    if (secondComma == std::string_view::npos) return false;
+
+    std::string_view sequenceText = text.substr(0, firstComma);
+    record.continued = sequenceText.back() == '+';
+    if (record.continued) {
+        sequenceText.remove_suffix(1);
+    }
+    if (sequenceText.empty()) return false;
+
+    uint64_t sequence = 0;
+    for (char c : sequenceText) {
+        if (c < '0' || c > '9') return false;
+        sequence = sequence * 10 + static_cast<uint64_t>(c - '0');
+    }
+    record.sequence = sequence;
+    record.accountNumber = std::string(text.substr(firstComma + 1, secondComma - firstComma - 1));
+    record.line = std::string(text.substr(secondComma + 1));
+    return true;
+}
+
+void appendRecord(std::string& out, const JournalRecord& record) {
+    out += std::to_string(record.sequence);
+    if (record.continued) {
+        out += '+';
+    }
+    out += ',';
+    out += record.accountNumber;
+    out += ',';
+    out += record.line;
+    out += '\n';
+}
+
+// Visit complete lines from the end of the file backwards until visit returns false
+template <typename Visit>
+void forEachLineReverse(int fd, Visit visit) {
+    off_t pos = lseek(fd, 0, SEEK_END);
+    std::string buffer;
+    char block[8192];
+    bool first = true;
+    while (pos > 0) {
+        size_t readSize = static_cast<size_t>(std::min<off_t>(sizeof(block), pos));
+        pos -= static_cast<off_t>(readSize);
+        ssize_t bytesRead = pread(fd, block, readSize, pos);
+        if (bytesRead != static_cast<ssize_t>(readSize)) return;
+        buffer.insert(0, block, readSize);
+        if (first) {
+            if (!buffer.empty() && buffer.back() == '\n') buffer.pop_back();
+            first = false;
+        }
+
+        size_t newline;
+        while ((newline = buffer.rfind('\n')) != std::string::npos) {
+            std::string_view line(buffer.data() + newline + 1, buffer.size() - newline - 1);
+            if (!line.empty() && !visit(line)) return;
+            buffer.resize(newline);
+        }
+    }
+    if (!buffer.empty()) {
+        visit(std::string_view(buffer));
+    }
+}
+
+bool writeAll(int fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = write(fd, data.data() + written, data.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Make a rename or file creation in dir durable
+bool syncDirectory(const std::string& dir) {
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+}
+
+Journal::Journal(const std::string& journalPath, const std::string& checkpointPath)
+    : journalPath_(journalPath), checkpointPath_(checkpointPath), fd_(-1), checkpoint_(0),
+      nextSequence_(1), durableSequence_(0), appliedSequence_(0), failed_(false), stopping_(false) {
+    if (access(failedMarkerPath().c_str(), F_OK) == 0) {
+        std::cerr << "Journal " << journalPath_ << " may hold a rejected transaction; check it and remove "
+                  << failedMarkerPath() << "\n";
+        failed_ = true;
+        return;
+    }
+    truncateIncompleteTransaction();
+
+    fd_ = open(journalPath_.c_str(), O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Failed to open journal " << journalPath_ << "\n";
+        failed_ = true;
+        return;
+    }
+
+    std::ifstream checkpointFile(checkpointPath_);
+    checkpointFile >> checkpoint_;
+
+    // A compacted log is empty, so sequences continue from the checkpoint
+    nextSequence_ = checkpoint_ + 1;
+    forEachLineReverse(fd_, [this](std::string_view line) {
+        JournalRecord record;
+        if (parseRecord(line, record)) {
+            nextSequence_ = std::max(nextSequence_, record.sequence + 1);
+            return false;
+        }
+        return true;
+    });
+    durableSequence_ = nextSequence_ - 1;
+}
+
+Journal::~Journal() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    pendingCv_.notify_all();
+    if (commitThread_.joinable()) {
+        commitThread_.join();
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+void Journal::truncateIncompleteTransaction() {
+    // A crash mid-write can leave a torn final line, or the first records of
+    // a transaction without its last one; drop them so the journal only holds
+    // whole transactions and new records start on a clean line
+    int fd = open(journalPath_.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) return;
+
+    off_t size = lseek(fd, 0, SEEK_END);
+    off_t keep = size;
+    char c = '\n';
+    while (keep > 0 && pread(fd, &c, 1, keep - 1) == 1 && c != '\n') {
+        --keep;
+    }
+    if (keep != size && ftruncate(fd, keep) != 0) {
+        std::cerr << "Failed to truncate torn journal record\n";
+        close(fd);
+        return;
+    }
+
+    // Every remaining line is complete; walk back over a trailing run of
+    // continued records, which lost the record that ended their transaction
+    size = keep;
+    forEachLineReverse(fd, [&](std::string_view line) {
+        JournalRecord record;
+        if (!parseRecord(line, record) || !record.continued) return false;
+        keep -= static_cast<off_t>(line.size()) + 1;
+        return true;
+    });
+
+    if (keep != size && ftruncate(fd, keep) != 0) {
+        std::cerr << "Failed to truncate incomplete journal transaction\n";
+    }
+    close(fd);
+}
+
+std::vector<JournalRecord> Journal::readRecordsAfter(uint64_t sequence) const {
+    std::vector<JournalRecord> records;
+    if (fd_ < 0) return records;
+
+    forEachLineReverse(fd_, [&](std::string_view line) {
+        JournalRecord record;
+        if (!parseRecord(line, record)) return true;
+        if (record.sequence <= sequence) return false;
+        records.push_back(std::move(record));
+        return true;
+    });
+    std::reverse(records.begin(), records.end());
+    return records;
+}
+
+std::vector<JournalRecord> Journal::unappliedRecords() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (failed_) return {};
+    return readRecordsAfter(checkpoint_);
+}
+
+bool Journal::setCheckpoint(uint64_t sequence) {
+    // Synced, renamed over the old checkpoint, and the rename synced through
+    // the directory, so a checkpoint that survives a crash is complete
+    std::string tmpPath = checkpointPath_ + ".tmp";
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    bool ok = writeAll(fd, std::to_string(sequence) + "\n") && fsync(fd) == 0;
+    close(fd);
+
+    std::string dir = std::filesystem::path(checkpointPath_).parent_path().string();
+    if (!ok || std::rename(tmpPath.c_str(), checkpointPath_.c_str()) != 0 ||
+        !syncDirectory(dir.empty() ? "." : dir)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    checkpoint_ = sequence;
+
+    // Only the commit thread writes, and it is the caller (or not started
+    // yet), so nothing can land between this check and the truncate
+    struct stat status;
+    if (fd_ >= 0 && sequence >= durableSequence_ && fstat(fd_, &status) == 0 && status.st_size > COMPACT_BYTES &&
+        ftruncate(fd_, 0) != 0) {
+        std::cerr << "Failed to compact journal\n";
+    }
+    return true;
+}
+
+void Journal::discardFailedBatch(off_t start, const std::vector<JournalRecord>& batch) {
+    struct stat status;
+    if (start >= 0 && fstat(fd_, &status) == 0 && status.st_size == start) {
+        return;     // nothing reached the file
+    }
+    if (start >= 0 && ftruncate(fd_, start) == 0 && fdatasync(fd_) == 0) {
+        return;
+    }
+
+    std::cerr << "Failed to remove a rejected transaction from the journal\n";
+    std::string marker = "sequences " + std::to_string(batch.front().sequence) + " to " +
+                         std::to_string(batch.back().sequence) + " were rejected but may remain in " +
+                         journalPath_ + "\n";
+    int fd = open(failedMarkerPath().c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+        writeAll(fd, marker);
+        fsync(fd);
+        close(fd);
+    }
+    std::string dir = std::filesystem::path(journalPath_).parent_path().string();
+    syncDirectory(dir.empty() ? "." : dir);
+}
+
+std::string Journal::failedMarkerPath() const {
+    return journalPath_ + ".failed";
+}
+
+void Journal::checkpointApplied() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (appliedSequence_ <= checkpoint_) return;
+    }
+    // A failed checkpoint is left where it was; recovery replays from there
+    if (!sync_() || !setCheckpoint(appliedSequence_)) {
+        std::cerr << "Journal checkpoint failed\n";
+    }
+}
+
+void Journal::start(ApplyFn apply, SyncFn sync) {
+    apply_ = std::move(apply);
+    sync_ = std::move(sync);
+    commitThread_ = std::thread(&Journal::commitLoop, this);
+}
+
+uint64_t Journal::enqueue(const std::vector<JournalRecord>& records) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < records.size(); ++i) {
+        pending_.push_back(records[i]);
+        pending_.back().sequence = nextSequence_++;
+        pending_.back().continued = i + 1 < records.size();
+        appendRecord(pendingBytes_, pending_.back());
+    }
+    pendingCv_.notify_one();
+    return nextSequence_ - 1;
+}
+
+bool Journal::waitDurable(uint64_t sequence) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    durableCv_.wait(lock, [&] { return durableSequence_ >= sequence || failed_; });
+    return durableSequence_ >= sequence;
+}
+
+uint64_t Journal::getLastSequence() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nextSequence_ - 1;
+}
+
+bool Journal::hasFailed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_;
+}
+
+void Journal::commitLoop() {
+    std::vector<JournalRecord> batch;
+    std::string bytes;
+    auto lastCheckpoint = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        pendingCv_.wait_for(lock, CHECKPOINT_INTERVAL, [this] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) {
+            // Idle or stopping: bring the checkpoint up to date
+            lock.unlock();
+            checkpointApplied();
+            lastCheckpoint = std::chrono::steady_clock::now();
+            lock.lock();
+            if (stopping_ && pending_.empty()) {
+                return;
+            }
+            continue;
+        }
+
+        // Take everything queued so far as one group; new callers keep
+        // queueing into the (now empty) pending buffers meanwhile
+        batch.swap(pending_);
+        bytes.swap(pendingBytes_);
+        lock.unlock();
+
+        off_t start = failed_ ? -1 : lseek(fd_, 0, SEEK_END);
+        bool ok = start >= 0 && writeAll(fd_, bytes) && fdatasync(fd_) == 0;
+        if (ok) {
+            apply_(batch);
+            appliedSequence_ = batch.back().sequence;
+        } else if (!failed_) {
+            std::cerr << "Journal write failed\n";
+            discardFailedBatch(start, batch);
+        }
+
+        lock.lock();
+        if (ok) {
+            durableSequence_ = batch.back().sequence;
+        } else {
+            failed_ = true;
+        }
+        batch.clear();
+        bytes.clear();
+        durableCv_.notify_all();
+
+        if (std::chrono::steady_clock::now() - lastCheckpoint >= CHECKPOINT_INTERVAL) {
+            lock.unlock();
+            checkpointApplied();
+            lastCheckpoint = std::chrono::steady_clock::now();
+            lock.lock();
+        }
+    }
+}
+
+} // namespace Banking
@@ -0,0 +1,117 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <sys/types.h>
+
+namespace Banking {
+
+// One statement line destined for an account's statement.csv
+struct JournalRecord {
+    uint64_t sequence = 0;
+    std::string accountNumber;
+    std::string line;
+    bool continued = false;     // more records of the same transaction follow
+};
+
+// Bank-wide append-only write-ahead log with group commit.
+//
+// Callers queue records with enqueue() and block in waitDurable(). A single
+// commit thread takes everything queued since its last pass, writes it with
+// one write + fdatasync and hands the batch to the apply callback, which
+// appends it to the derived statement files without syncing them.
+//
+// At most once per CHECKPOINT_INTERVAL, and when idle or stopping, the commit
+// thread calls the sync callback to make those appends durable and only then
+// durably records the checkpoint. A checkpoint therefore never covers
+// statement lines a power loss could take back; records after it are
+// replayed on the next start, idempotently. Once a checkpoint covers every
+// record and the log has grown past COMPACT_BYTES, the log is truncated;
+// sequences carry on from the checkpoint.
+//
+// A batch whose write or sync fails is cut back out of the log, so a
+// transaction its callers were told failed is never replayed. If that cut
+// fails as well, a marker file is left next to the log and the journal
+// refuses to start until an operator has checked the log and removed it.
+//
+// File format, one record per line: sequence[+],account,statement line
+// where '+' marks a record whose transaction continues on the next line.
+// Records enqueued together form one transaction: on recovery, a trailing
+// transaction that was not completely written is discarded as a whole.
+class Journal {
+public:
+    using ApplyFn = std::function<void(const std::vector<JournalRecord>&)>;
+    using SyncFn = std::function<bool()>;
+
+    static constexpr std::chrono::seconds CHECKPOINT_INTERVAL{1};
+    static constexpr off_t COMPACT_BYTES = 1 << 20;
+
+    Journal(const std::string& journalPath, const std::string& checkpointPath);
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Records after the checkpoint, i.e. durable but possibly not yet applied
+    std::vector<JournalRecord> unappliedRecords() const;
+
+    // Durably mark everything up to sequence as applied to the statement
+    // files, which must already be synced; false if it could not be written
+    bool setCheckpoint(uint64_t sequence);
+
+    // Start the commit thread; apply is called once per durable batch, and
+    // sync before each checkpoint to make the applied batches durable
+    void start(ApplyFn apply, SyncFn sync);
+
+    // Queue records as one transaction; returns the last sequence
+    uint64_t enqueue(const std::vector<JournalRecord>& records);
+
+    // Block until sequence is durable and applied; false if the write failed
+    bool waitDurable(uint64_t sequence);
+
+    uint64_t getLastSequence() const;
+
+    // Whether a write has failed; nothing is committed after that
+    bool hasFailed() const;
+
+    // Left next to the log when a failed batch could not be cut back out
+    std::string failedMarkerPath() const;
+
+private:
+    std::string journalPath_;
+    std::string checkpointPath_;
+    int fd_;
+    uint64_t checkpoint_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable pendingCv_;
+    std::condition_variable durableCv_;
+    std::vector<JournalRecord> pending_;
+    std::string pendingBytes_;
+    uint64_t nextSequence_;
+    uint64_t durableSequence_;
+    uint64_t appliedSequence_;      // last sequence applied; commit thread only
+    bool failed_;
+    bool stopping_;
+
+    ApplyFn apply_;
+    SyncFn sync_;
+    std::thread commitThread_;
+
+    void commitLoop();
+    void checkpointApplied();
+    std::vector<JournalRecord> readRecordsAfter(uint64_t sequence) const;
+    void truncateIncompleteTransaction();
+    void discardFailedBatch(off_t start, const std::vector<JournalRecord>& batch);
+};
+
+} // namespace Banking
+
+#endif // JOURNAL_H
@@ -0,0 +1,139 @@
+#include "JsonWriter.h"
+#include <charconv>
+#include <cstring>
+
+namespace Banking {
+
+namespace {
+constexpr uint64_t ONES = 0x0101010101010101ull;
+constexpr uint64_t HIGH_BITS = 0x8080808080808080ull;
+
+bool needsEscape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+// Nonzero if any byte of word is zero (exact as an any-test)
+uint64_t zeroByte(uint64_t word) {
+    return (word - ONES) & ~word & HIGH_BITS;
+}
+
+// Whether any of the 8 bytes at text is a control character, '"' or '\\'
+bool wordNeedsEscape(const char* text) {
+    uint64_t word;
+    std::memcpy(&word, text, sizeof(word));
+    uint64_t control = (word - ONES * 0x20) & ~word & HIGH_BITS;
+    return (control | zeroByte(word ^ (ONES * '"')) | zeroByte(word ^ (ONES * '\\'))) != 0;
+}
+}
+
+JsonWriter::JsonWriter(std::string& out) : out_(out), needComma_(false) {}
+
+void JsonWriter::separate() {
+    if (needComma_) {
+        out_ += ',';
+    }
+    needComma_ = true;
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    out_ += '{';
+    needComma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    out_ += '}';
+    needComma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    out_ += '[';
+    needComma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    out_ += ']';
+    needComma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separate();
+    out_ += '"';
+    appendEscaped(out_, name);
+    out_ += "\":";
+    needComma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view text) {
+    separate();
+    out_ += '"';
+    appendEscaped(out_, text);
+    out_ += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* text) {
+    return value(std::string_view(text));
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    return rawValue(flag ? "true" : "false");
+}
+
+JsonWriter& JsonWriter::value(int64_t number) {
+    char text[24];
+    auto result = std::to_chars(text, text + sizeof(text), number);
+    return rawValue(std::string_view(text, static_cast<size_t>(result.ptr - text)));
+}
+
+JsonWriter& JsonWriter::value(uint64_t number) {
+    char text[24];
+    auto result = std::to_chars(text, text + sizeof(text), number);
+    return rawValue(std::string_view(text, static_cast<size_t>(result.ptr - text)));
+}
+
+JsonWriter& JsonWriter::rawValue(std::string_view json) {
+    separate();
+    out_ += json;
+    return *this;
+}
+
+void JsonWriter::appendEscaped(std::string& out, std::string_view text) {
+    static const char* hex = "0123456789abcdef";
+    const char* pos = text.data();
+    const char* end = pos + text.size();
+    while (pos < end) {
+        // Find the next character that needs escaping, eight bytes at a time
+        // while the words are clean, and copy the clean run in one append
+        const char* run = pos;
+        while (end - pos >= 8 && !wordNeedsEscape(pos)) {
+            pos += 8;
+        }
+        while (pos < end && !needsEscape(static_cast<unsigned char>(*pos))) {
+            ++pos;
+        }
+        out.append(run, static_cast<size_t>(pos - run));
+        if (pos == end) break;
+
+        char c = *pos++;
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: {
+                char escape[6] = {'\\', 'u', '0', '0', hex[(c >> 4) & 0xf], hex[c & 0xf]};
+                out.append(escape, sizeof(escape));
+            }
+        }
+    }
+}
+
+} // namespace Banking
@@ -0,0 +1,49 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+namespace Banking {
+
+// Append-only JSON writer into a caller's buffer. Commas are inserted
+// automatically; the caller is responsible for balancing begin/end calls.
+//
+//   JsonWriter json(out);
+//   json.beginObject().key("success").value(true).key("data").beginArray();
+//   ...
+//   json.endArray().endObject();
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out);
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const char* text);
+    JsonWriter& value(bool flag);
+    JsonWriter& value(int64_t number);
+    JsonWriter& value(uint64_t number);
+
+    // Already-encoded JSON, e.g. a decimal amount
+    JsonWriter& rawValue(std::string_view json);
+
+    // Append text as the contents of a JSON string (without quotes)
+    static void appendEscaped(std::string& out, std::string_view text);
+
+private:
+    std::string& out_;
+    bool needComma_;
+
+    void separate();
+};
+
+} // namespace Banking
+
+#endif // JSON_WRITER_H
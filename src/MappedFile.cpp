@@ -0,0 +1,91 @@
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <utility>
+
+namespace Banking {
+
+MappedFile::MappedFile(const std::string& path)
+    : path_(path), data_(nullptr), size_(0), device_(0), inode_(0) {}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : path_(std::move(other.path_)), data_(other.data_), size_(other.size_),
+      device_(other.device_), inode_(other.inode_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        path_ = std::move(other.path_);
+        data_ = other.data_;
+        size_ = other.size_;
+        device_ = other.device_;
+        inode_ = other.inode_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void MappedFile::unmap() {
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+        data_ = nullptr;
+    }
+    size_ = 0;
+}
+
+bool MappedFile::refresh() {
+    struct stat st;
+    if (stat(path_.c_str(), &st) != 0) {
+        unmap();
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size == size_ && st.st_dev == device_ && st.st_ino == inode_ && (data_ != nullptr || size == 0)) {
+        return true;
+    }
+
+    unmap();
+    device_ = st.st_dev;
+    inode_ = st.st_ino;
+    if (size == 0) {
+        return true;
+    }
+
+    int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    // Size the mapping from the descriptor actually opened, in case the file
+    // changed between stat() and open()
+    if (fstat(fd, &st) == 0) {
+        size = static_cast<size_t>(st.st_size);
+        device_ = st.st_dev;
+        inode_ = st.st_ino;
+    }
+    if (size > 0) {
+        void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data != MAP_FAILED) {
+            data_ = static_cast<char*>(data);
+            size_ = size;
+        }
+    }
+    close(fd);
+    return size == 0 || data_ != nullptr;
+}
+
+std::string_view MappedFile::view() const {
+    return std::string_view(data_, size_);
+}
+
+} // namespace Banking
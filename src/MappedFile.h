@@ -0,0 +1,41 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+
+namespace Banking {
+
+// Read-only memory mapping of a whole file. refresh() checks the file and
+// remaps it when it has grown, shrunk or been replaced, so a long-lived
+// mapping follows a file that is only ever appended to.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Bring the mapping up to date; false if the file cannot be read
+    bool refresh();
+
+    // The mapped bytes; valid until the next refresh()
+    std::string_view view() const;
+
+private:
+    std::string path_;
+    char* data_;
+    size_t size_;
+    dev_t device_;
+    ino_t inode_;
+
+    void unmap();
+};
+
+} // namespace Banking
+
+#endif // MAPPED_FILE_H
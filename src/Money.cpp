@@ -0,0 +1,97 @@
+#include "Money.h"
+#include <ostream>
+
+namespace Banking {
+
+namespace {
+// Keeps cents well inside int64_t and the text inside MAX_TEXT_LENGTH
+constexpr size_t MAX_WHOLE_DIGITS = 16;
+}
+
+bool Money::parse(std::string_view text, Money& money) {
+    bool negative = false;
+    if (!text.empty() && (text.front() == '-' || text.front() == '+')) {
+        negative = text.front() == '-';
+        text.remove_prefix(1);
+    }
+
+    size_t dot = text.find('.');
+    std::string_view whole = text.substr(0, dot);
+    std::string_view fraction = dot == std::string_view::npos ? std::string_view() : text.substr(dot + 1);
+    if (whole.size() > MAX_WHOLE_DIGITS || fraction.size() > 2) return false;
+    if (whole.empty() && fraction.empty()) return false;
+    if (dot != std::string_view::npos && fraction.empty()) return false;
+
+    int64_t cents = 0;
+    for (char c : whole) {
+        if (c < '0' || c > '9') return false;
+        cents = cents * 10 + (c - '0');
+    }
+    for (size_t i = 0; i < 2; ++i) {
+        char c = i < fraction.size() ? fraction[i] : '0';
+        if (c < '0' || c > '9') return false;
+        cents = cents * 10 + (c - '0');
+    }
+
+    money.cents_ = negative ? -cents : cents;
+    return true;
+}
+
+bool Money::add(Money a, Money b, Money& result) {
+    int64_t cents;
+    if (__builtin_add_overflow(a.cents_, b.cents_, &cents)) return false;
+    result.cents_ = cents;
+    return true;
+}
+
+bool Money::subtract(Money a, Money b, Money& result) {
+    int64_t cents;
+    if (__builtin_sub_overflow(a.cents_, b.cents_, &cents)) return false;
+    result.cents_ = cents;
+    return true;
+}
+
+size_t Money::format(char* buffer) const {
+    // Digits are produced backwards into a scratch area, then copied out
+    char digits[MAX_TEXT_LENGTH];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    uint64_t value = cents_ < 0 ? 0 - static_cast<uint64_t>(cents_) : static_cast<uint64_t>(cents_);
+
+    *--p = static_cast<char>('0' + value % 10);
+    value /= 10;
+    *--p = static_cast<char>('0' + value % 10);
+    value /= 10;
+    *--p = '.';
+    do {
+        *--p = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0 && p > digits + 1);
+    if (cents_ < 0) {
+        *--p = '-';
+    }
+
+    size_t length = static_cast<size_t>(end - p);
+    for (size_t i = 0; i < length; ++i) {
+        buffer[i] = p[i];
+    }
+    return length;
+}
+
+void Money::appendTo(std::string& out) const {
+    char buffer[MAX_TEXT_LENGTH];
+    out.append(buffer, format(buffer));
+}
+
+std::string Money::toString() const {
+    std::string text;
+    appendTo(text);
+    return text;
+}
+
+std::ostream& operator<<(std::ostream& out, Money money) {
+    char buffer[Money::MAX_TEXT_LENGTH];
+    return out.write(buffer, static_cast<std::streamsize>(money.format(buffer)));
+}
+
+} // namespace Banking
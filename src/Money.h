@@ -0,0 +1,74 @@
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <compare>
+#include <iosfwd>
+
+namespace Banking {
+
+// An exact amount of money held as a whole number of cents
+class Money {
+public:
+    // Longest text written by appendTo: sign, 17 digits, '.' and 2 decimals
+    static constexpr size_t MAX_TEXT_LENGTH = 21;
+
+    constexpr Money() = default;
+
+    static constexpr Money fromCents(int64_t cents) {
+        Money money;
+        money.cents_ = cents;
+        return money;
+    }
+
+    // Parse "12", "12.5" or "-0.07": an optional sign, digits and at most two
+    // decimal places. No exponents, separators or whitespace.
+    static bool parse(std::string_view text, Money& money);
+
+    constexpr int64_t cents() const { return cents_; }
+
+    // a + b or a - b into result; false, leaving result alone, if it would
+    // overflow int64_t
+    static bool add(Money a, Money b, Money& result);
+    static bool subtract(Money a, Money b, Money& result);
+
+    // Always two decimal places, e.g. "1234.50"
+    std::string toString() const;
+    void appendTo(std::string& out) const;
+
+    // Writes to buffer (at least MAX_TEXT_LENGTH bytes); returns the length
+    size_t format(char* buffer) const;
+
+    constexpr auto operator<=>(const Money&) const = default;
+
+    constexpr Money operator-() const { return fromCents(-cents_); }
+    constexpr Money operator+(Money other) const { return fromCents(cents_ + other.cents_); }
+    constexpr Money operator-(Money other) const { return fromCents(cents_ - other.cents_); }
+    constexpr Money& operator+=(Money other) { cents_ += other.cents_; return *this; }
+    constexpr Money& operator-=(Money other) { cents_ -= other.cents_; return *this; }
+
+private:
+    int64_t cents_ = 0;
+};
+
+std::ostream& operator<<(std::ostream& out, Money money);
+
+// Largest balance an account may hold. Deposits and transfers that would take
+// a balance past it are refused, so balances always fit a statement line, and
+// the bank's total stays inside int64_t even with every 8-digit account full.
+constexpr Money MAX_BALANCE = Money::fromCents(100'000'000'00);
+
+// 12.50_money, for constants and tests
+constexpr Money operator""_money(long double amount) {
+    return Money::fromCents(static_cast<int64_t>(amount * 100 + (amount < 0 ? -0.5L : 0.5L)));
+}
+
+constexpr Money operator""_money(unsigned long long amount) {
+    return Money::fromCents(static_cast<int64_t>(amount) * 100);
+}
+
+} // namespace Banking
+
+#endif // MONEY_H
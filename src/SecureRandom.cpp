@@ -0,0 +1,142 @@
+#include "SecureRandom.h"
+#include <sys/random.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+namespace Banking {
+
+namespace {
+constexpr size_t KEY_BYTES = 32;
+constexpr size_t BLOCK_BYTES = 64;
+constexpr size_t BUFFER_BLOCKS = 8;
+
+// Seed material straight from the kernel. Session ids and PIN salts must not
+// come from anything weaker, so with no entropy source the process aborts
+// rather than run on an unseeded key.
+void systemRandomBytes(uint8_t* out, size_t length) {
+    while (length > 0) {
+        ssize_t got = getrandom(out, length, 0);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        out += got;
+        length -= static_cast<size_t>(got);
+    }
+    if (length == 0) return;
+
+    // Kernels without getrandom()
+    int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+    while (fd >= 0 && length > 0) {
+        ssize_t got = read(fd, out, length);
+        if (got <= 0) {
+            if (got < 0 && errno == EINTR) continue;
+            break;
+        }
+        out += got;
+        length -= static_cast<size_t>(got);
+    }
+    if (fd >= 0) close(fd);
+    if (length > 0) {
+        std::fputs("Fatal: no kernel entropy source (getrandom and /dev/urandom both failed)\n", stderr);
+        std::abort();
+    }
+}
+
+uint32_t rotl(uint32_t x, int n) {
+    return (x << n) | (x >> (32 - n));
+}
+
+void quarterRound(uint32_t* s, int a, int b, int c, int d) {
+    s[a] += s[b]; s[d] = rotl(s[d] ^ s[a], 16);
+    s[c] += s[d]; s[b] = rotl(s[b] ^ s[c], 12);
+    s[a] += s[b]; s[d] = rotl(s[d] ^ s[a], 8);
+    s[c] += s[d]; s[b] = rotl(s[b] ^ s[c], 7);
+}
+
+// One ChaCha20 block (RFC 8439) with a zero nonce
+void chachaBlock(const uint32_t key[8], uint32_t counter, uint8_t out[BLOCK_BYTES]) {
+    uint32_t input[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+                          key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7],
+                          counter, 0, 0, 0};
+    uint32_t state[16];
+    std::memcpy(state, input, sizeof(state));
+    for (int i = 0; i < 10; ++i) {
+        quarterRound(state, 0, 4, 8, 12);
+        quarterRound(state, 1, 5, 9, 13);
+        quarterRound(state, 2, 6, 10, 14);
+        quarterRound(state, 3, 7, 11, 15);
+        quarterRound(state, 0, 5, 10, 15);
+        quarterRound(state, 1, 6, 11, 12);
+        quarterRound(state, 2, 7, 8, 13);
+        quarterRound(state, 3, 4, 9, 14);
+    }
+    for (int i = 0; i < 16; ++i) {
+        uint32_t word = state[i] + input[i];
+        out[4 * i] = static_cast<uint8_t>(word);
+        out[4 * i + 1] = static_cast<uint8_t>(word >> 8);
+        out[4 * i + 2] = static_cast<uint8_t>(word >> 16);
+        out[4 * i + 3] = static_cast<uint8_t>(word >> 24);
+    }
+}
+
+// Keystream generator with fast key erasure: each refill produces a buffer
+// of blocks whose first 32 bytes become the next key and are never handed
+// out, and bytes are wiped as they are returned, so a later memory dump
+// cannot reveal earlier output.
+class Generator {
+public:
+    Generator() {
+        uint8_t seed[KEY_BYTES];
+        systemRandomBytes(seed, sizeof(seed));
+        setKey(seed);
+        std::memset(seed, 0, sizeof(seed));
+    }
+
+    void fill(uint8_t* out, size_t length) {
+        while (length > 0) {
+            if (available_ == 0) refill();
+            size_t take = std::min(length, available_);
+            uint8_t* source = buffer_ + sizeof(buffer_) - available_;
+            std::memcpy(out, source, take);
+            std::memset(source, 0, take);
+            available_ -= take;
+            out += take;
+            length -= take;
+        }
+    }
+
+private:
+    uint32_t key_[8];
+    uint8_t buffer_[BUFFER_BLOCKS * BLOCK_BYTES];
+    size_t available_ = 0;
+
+    void setKey(const uint8_t* bytes) {
+        for (int i = 0; i < 8; ++i) {
+            key_[i] = uint32_t{bytes[4 * i]} | (uint32_t{bytes[4 * i + 1]} << 8) |
+                      (uint32_t{bytes[4 * i + 2]} << 16) | (uint32_t{bytes[4 * i + 3]} << 24);
+        }
+    }
+
+    void refill() {
+        for (size_t i = 0; i < BUFFER_BLOCKS; ++i) {
+            chachaBlock(key_, static_cast<uint32_t>(i), buffer_ + i * BLOCK_BYTES);
+        }
+        setKey(buffer_);
+        std::memset(buffer_, 0, KEY_BYTES);
+        available_ = sizeof(buffer_) - KEY_BYTES;
+    }
+};
+}
+
+void secureRandomBytes(uint8_t* out, size_t length) {
+    thread_local Generator generator;
+    generator.fill(out, length);
+}
+
+} // namespace Banking
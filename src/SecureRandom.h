@@ -0,0 +1,17 @@
+#ifndef SECURE_RANDOM_H
+#define SECURE_RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Banking {
+
+// Fill out with cryptographically strong random bytes. Each thread runs its
+// own ChaCha20 generator keyed from getrandom(), so callers on different
+// threads never share state or contend. Aborts the process if the kernel
+// gives no entropy at all.
+void secureRandomBytes(uint8_t* out, size_t length);
+
+} // namespace Banking
+
+#endif // SECURE_RANDOM_H
@@ -0,0 +1,207 @@
+#include "SessionStore.h"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <functional>
+#include <algorithm>
+
+namespace Banking {
+
+SessionStore::SessionStore(const SessionConfig& config, const std::string& snapshotPath)
+    : config_(config), snapshotPath_(snapshotPath),
+      shardCapacity_(std::max<size_t>(1, (config.maxSessions + SHARD_COUNT - 1) / SHARD_COUNT)),
+      created_(0), expired_(0), evicted_(0), loggedOut_(0), stopping_(false) {
+    if (config_.persistSnapshot) {
+        loadSnapshot();
+    }
+    reaperThread_ = std::thread(&SessionStore::reaperLoop, this);
+}
+
+SessionStore::~SessionStore() {
+    {
+        std::lock_guard<std::mutex> lock(reaperMutex_);
+        stopping_ = true;
+    }
+    reaperCv_.notify_all();
+    if (reaperThread_.joinable()) {
+        reaperThread_.join();
+    }
+    if (config_.persistSnapshot) {
+        saveSnapshot();
+    }
+}
+
+SessionStore::Shard& SessionStore::shardFor(const std::string& sessionId) {
+    return shards_[std::hash<std::string>{}(sessionId) % SHARD_COUNT];
+}
+
+const SessionStore::Shard& SessionStore::shardFor(const std::string& sessionId) const {
+    return shards_[std::hash<std::string>{}(sessionId) % SHARD_COUNT];
+}
+
+bool SessionStore::isExpired(const Session& session, Clock::time_point now) const {
+    return session.expiresAt <= now || session.lastAccess + config_.idleTtl <= now;
+}
+
+void SessionStore::insert(Shard& shard, const std::string& sessionId, const std::string& accountNumber,
+                          Clock::time_point expiresAt, Clock::time_point now) {
+    auto existing = shard.sessions.find(sessionId);
+    if (existing != shard.sessions.end()) {
+        shard.lru.erase(existing->second.lruPosition);
+        shard.sessions.erase(existing);
+    }
+
+    // Make room by evicting the least recently used session
+    while (shard.sessions.size() >= shardCapacity_ && !shard.lru.empty()) {
+        bool idle = isExpired(shard.sessions.at(shard.lru.back()), now);
+        shard.sessions.erase(shard.lru.back());
+        shard.lru.pop_back();
+        ++(idle ? expired_ : evicted_);
+    }
+
+    shard.lru.push_front(sessionId);
+    shard.sessions[sessionId] = {accountNumber, expiresAt, now, shard.lru.begin()};
+}
+
+void SessionStore::create(const std::string& sessionId, const std::string& accountNumber) {
+    auto now = Clock::now();
+    Shard& shard = shardFor(sessionId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    insert(shard, sessionId, accountNumber, now + config_.absoluteTtl, now);
+    ++created_;
+}
+
+std::string SessionStore::lookup(const std::string& sessionId) {
+    auto now = Clock::now();
+    Shard& shard = shardFor(sessionId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(sessionId);
+    if (it == shard.sessions.end()) {
+        return "";
+    }
+
+    Session& session = it->second;
+    if (isExpired(session, now)) {
+        shard.lru.erase(session.lruPosition);
+        shard.sessions.erase(it);
+        ++expired_;
+        return "";
+    }
+
+    session.lastAccess = now;
+    shard.lru.splice(shard.lru.begin(), shard.lru, session.lruPosition);
+    return session.accountNumber;
+}
+
+bool SessionStore::remove(const std::string& sessionId) {
+    Shard& shard = shardFor(sessionId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(sessionId);
+    if (it == shard.sessions.end()) {
+        return false;
+    }
+    bool live = !isExpired(it->second, Clock::now());
+    shard.lru.erase(it->second.lruPosition);
+    shard.sessions.erase(it);
+    ++(live ? loggedOut_ : expired_);
+    return live;
+}
+
+size_t SessionStore::reapExpired() {
+    auto now = Clock::now();
+    size_t removed = 0;
+    for (Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        // The tail holds the longest-idle sessions; stop at the first one
+        // that is still in use
+        while (!shard.lru.empty()) {
+            auto it = shard.sessions.find(shard.lru.back());
+            if (!isExpired(it->second, now)) break;
+            shard.sessions.erase(it);
+            shard.lru.pop_back();
+            ++removed;
+        }
+    }
+    expired_ += removed;
+    return removed;
+}
+
+SessionStats SessionStore::getStats() const {
+    SessionStats stats;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.live += shard.sessions.size();
+    }
+    stats.created = created_;
+    stats.expired = expired_;
+    stats.evicted = evicted_;
+    stats.loggedOut = loggedOut_;
+    return stats;
+}
+
+bool SessionStore::saveSnapshot() const {
+    // One line per session: id,account,expiry (seconds since epoch)
+    std::ostringstream snapshot;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& [sessionId, session] : shard.sessions) {
+            auto expires = std::chrono::duration_cast<std::chrono::seconds>(session.expiresAt.time_since_epoch());
+            snapshot << sessionId << "," << session.accountNumber << "," << expires.count() << "\n";
+        }
+    }
+
+    std::string tmpPath = snapshotPath_ + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::trunc);
+        if (!file.is_open()) return false;
+        file << snapshot.str();
+        if (!file) return false;
+    }
+    return std::rename(tmpPath.c_str(), snapshotPath_.c_str()) == 0;
+}
+
+void SessionStore::loadSnapshot() {
+    std::ifstream file(snapshotPath_);
+    if (!file.is_open()) return;
+
+    auto now = Clock::now();
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream ss(line);
+        std::string sessionId, accountNumber, expiresStr;
+        std::getline(ss, sessionId, ',');
+        std::getline(ss, accountNumber, ',');
+        std::getline(ss, expiresStr, ',');
+        if (sessionId.empty() || accountNumber.empty() || expiresStr.empty()) continue;
+
+        Clock::time_point expiresAt;
+        try {
+            expiresAt = Clock::time_point(std::chrono::seconds(std::stoll(expiresStr)));
+        } catch (...) {
+            continue;
+        }
+        if (expiresAt <= now) continue;
+
+        // Restored sessions get a fresh idle timer
+        Shard& shard = shardFor(sessionId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        insert(shard, sessionId, accountNumber, expiresAt, now);
+    }
+}
+
+void SessionStore::reaperLoop() {
+    std::unique_lock<std::mutex> lock(reaperMutex_);
+    while (!stopping_) {
+        reaperCv_.wait_for(lock, config_.reapInterval, [this] { return stopping_; });
+        if (stopping_) break;
+
+        lock.unlock();
+        reapExpired();
+        if (config_.persistSnapshot) {
+            saveSnapshot();
+        }
+        lock.lock();
+    }
+}
+
+} // namespace Banking
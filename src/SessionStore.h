@@ -0,0 +1,116 @@
+#ifndef SESSION_STORE_H
+#define SESSION_STORE_H
+
+#include <string>
+#include <array>
+#include <unordered_map>
+#include <list>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+
+namespace Banking {
+
+struct SessionConfig {
+    // Sessions expire this long after login...
+    std::chrono::seconds absoluteTtl{8 * 60 * 60};
+
+    // ...or after this long without being used
+    std::chrono::seconds idleTtl{30 * 60};
+
+    // Hard cap on live sessions; logging in beyond it evicts the least
+    // recently used session
+    size_t maxSessions = 100000;
+
+    // How often the reaper drops expired sessions (and writes the snapshot)
+    std::chrono::seconds reapInterval{30};
+
+    // Keep sessions across restarts by snapshotting them to snapshotPath
+    bool persistSnapshot = false;
+};
+
+struct SessionStats {
+    size_t live = 0;
+    uint64_t created = 0;
+    uint64_t expired = 0;
+    uint64_t evicted = 0;
+    uint64_t loggedOut = 0;
+};
+
+// Concurrent in-memory session table: session id -> account number.
+// Split into independently locked shards so lookups from different request
+// threads rarely contend. Each shard keeps its sessions in least recently
+// used order and holds at most maxSessions / SHARD_COUNT of them.
+// A background reaper removes idle sessions from the LRU tail; sessions past
+// their absolute TTL are dropped when next looked up or when they go idle.
+class SessionStore {
+public:
+    using Clock = std::chrono::system_clock;
+
+    SessionStore(const SessionConfig& config, const std::string& snapshotPath);
+    ~SessionStore();
+
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+    void create(const std::string& sessionId, const std::string& accountNumber);
+
+    // Account number for a live session, or empty string; refreshes the
+    // session's idle timer
+    std::string lookup(const std::string& sessionId);
+
+    bool remove(const std::string& sessionId);
+
+    // Drop expired sessions; returns how many were removed
+    size_t reapExpired();
+
+    SessionStats getStats() const;
+
+    bool saveSnapshot() const;
+    void loadSnapshot();
+
+private:
+    static constexpr size_t SHARD_COUNT = 16;
+
+    struct Session {
+        std::string accountNumber;
+        Clock::time_point expiresAt;
+        Clock::time_point lastAccess;
+        std::list<std::string>::iterator lruPosition;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Session> sessions;
+        std::list<std::string> lru;     // most recently used first
+    };
+
+    SessionConfig config_;
+    std::string snapshotPath_;
+    size_t shardCapacity_;
+    std::array<Shard, SHARD_COUNT> shards_;
+
+    std::atomic<uint64_t> created_;
+    std::atomic<uint64_t> expired_;
+    std::atomic<uint64_t> evicted_;
+    std::atomic<uint64_t> loggedOut_;
+
+    std::mutex reaperMutex_;
+    std::condition_variable reaperCv_;
+    bool stopping_;
+    std::thread reaperThread_;
+
+    Shard& shardFor(const std::string& sessionId);
+    const Shard& shardFor(const std::string& sessionId) const;
+    void insert(Shard& shard, const std::string& sessionId, const std::string& accountNumber,
+                Clock::time_point expiresAt, Clock::time_point now);
+    bool isExpired(const Session& session, Clock::time_point now) const;
+    void reaperLoop();
+};
+
+} // namespace Banking
+
+#endif // SESSION_STORE_H
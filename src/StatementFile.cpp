@@ -0,0 +1,347 @@
+#include "StatementFile.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+namespace Banking {
+
+namespace {
+StatementRecord recordAt(std::string_view data, size_t index) {
+    // Copied out rather than cast in place: the mapping gives no alignment
+    // or lifetime guarantees to rely on
+    StatementRecord record;
+    std::memcpy(&record, data.data() + index * sizeof(StatementRecord), sizeof(StatementRecord));
+    return record;
+}
+}
+
+const char* transactionTypeName(TransactionType type) {
+    switch (type) {
+        case TransactionType::DEPOSIT: return "DEPOSIT";
+        case TransactionType::DEBIT: return "DEBIT";
+        case TransactionType::TRANSFER_IN: return "TRANSFER_IN";
+        case TransactionType::TRANSFER_OUT: return "TRANSFER_OUT";
+        case TransactionType::ACCOUNT_CREATED: return "ACCOUNT_CREATED";
+    }
+    return "";
+}
+
+bool parseTransactionType(std::string_view name, TransactionType& type) {
+    for (TransactionType candidate : {TransactionType::DEPOSIT, TransactionType::DEBIT,
+                                      TransactionType::TRANSFER_IN, TransactionType::TRANSFER_OUT,
+                                      TransactionType::ACCOUNT_CREATED}) {
+        if (name == transactionTypeName(candidate)) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace {
+// timestamp,type,amount,balance
+bool splitStatementLine(std::string_view line, std::string_view (&fields)[4]) {
+    for (int i = 0; i < 3; ++i) {
+        size_t comma = line.find(',');
+        if (comma == std::string_view::npos) return false;
+        fields[i] = line.substr(0, comma);
+        line.remove_prefix(comma + 1);
+    }
+    fields[3] = line;
+    if (!fields[3].empty() && fields[3].back() == '\r') {
+        fields[3].remove_suffix(1);
+    }
+    return true;
+}
+}
+
+bool parseStatementLine(std::string_view line, StatementRecord& record) {
+    std::string_view fields[4];
+    if (!splitStatementLine(line, fields)) return false;
+
+    TimestampValue timestamp;
+    TransactionType type;
+    Money amount;
+    Money balance;
+    if (!parseTimestamp(fields[0], timestamp) || !parseTransactionType(fields[1], type) ||
+        !Money::parse(fields[2], amount) || !Money::parse(fields[3], balance)) {
+        return false;
+    }
+    record.timestamp = timestamp.seconds;
+    record.milliseconds = timestamp.milliseconds;
+    record.flags = static_cast<uint16_t>((timestamp.format.utc ? TIMESTAMP_UTC : 0) |
+                                         (timestamp.format.milliseconds ? TIMESTAMP_MILLISECONDS : 0));
+    record.amountCents = amount.cents();
+    record.balanceCents = balance.cents();
+    record.type = static_cast<uint32_t>(type);
+    return true;
+}
+
+std::string formatStatementLine(const StatementRecord& record) {
+    TimestampValue timestamp;
+    timestamp.seconds = record.timestamp;
+    timestamp.milliseconds = record.milliseconds;
+    timestamp.format.utc = (record.flags & TIMESTAMP_UTC) != 0;
+    timestamp.format.milliseconds = (record.flags & TIMESTAMP_MILLISECONDS) != 0;
+
+    std::string line;
+    line.reserve(MAX_TIMESTAMP_LENGTH + 48);
+    appendTimestamp(line, timestamp);
+    line += ',';
+    line += transactionTypeName(static_cast<TransactionType>(record.type));
+    line += ',';
+    Money::fromCents(record.amountCents).appendTo(line);
+    line += ',';
+    Money::fromCents(record.balanceCents).appendTo(line);
+    return line;
+}
+
+bool parseStatementLine(std::string_view line, Transaction& transaction) {
+    // The timestamp stays text, so only its shape is checked
+    std::string_view fields[4];
+    if (!splitStatementLine(line, fields) || !isTimestamp(fields[0]) ||
+        !parseTransactionType(fields[1], transaction.type) || !Money::parse(fields[2], transaction.amount) ||
+        !Money::parse(fields[3], transaction.balance)) {
+        return false;
+    }
+    transaction.timestamp = std::string(fields[0]);
+    return true;
+}
+
+StatementFile::StatementFile(const std::string& path, StatementFormat format)
+    : path_(path), format_(format), mapping_(path) {}
+
+const char* StatementFile::fileName(StatementFormat format) {
+    return format == StatementFormat::Binary ? "statement.bin" : "statement.csv";
+}
+
+bool StatementFile::append(const std::vector<std::string>& lines) const {
+    if (format_ == StatementFormat::Csv) {
+        std::string text;
+        for (const auto& line : lines) {
+            text += line;
+            text += '\n';
+        }
+        std::ofstream file(path_, std::ios::app | std::ios::binary);
+        file.write(text.data(), static_cast<std::streamsize>(text.size()));
+        return static_cast<bool>(file);
+    }
+
+    std::vector<StatementRecord> records(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (!parseStatementLine(lines[i], records[i])) return false;
+    }
+
+    int fd = open(path_.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    const char* data = reinterpret_cast<const char*>(records.data());
+    size_t bytes = records.size() * sizeof(StatementRecord);
+    size_t written = 0;
+    while (written < bytes) {
+        ssize_t n = write(fd, data + written, bytes - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        written += static_cast<size_t>(n);
+    }
+    close(fd);
+    return written == bytes;
+}
+
+bool StatementFile::visitTail(size_t count, const LineVisitor& visit) {
+    if (!mapping_.refresh()) return false;
+    if (count == 0) return true;
+    std::string_view data = mapping_.view();
+
+    if (format_ == StatementFormat::Binary) {
+        // A torn final record is ignored
+        size_t available = data.size() / sizeof(StatementRecord);
+        std::string line;
+        for (size_t i = available - std::min(count, available); i < available; ++i) {
+            line = formatStatementLine(recordAt(data, i));
+            visit(line);
+        }
+        return true;
+    }
+
+    if (data.empty()) return true;
+
+    // Walk back over count line starts; the newline ending the last line
+    // does not start another one. A final line without its newline is
+    // visited as is.
+    size_t end = data.back() == '\n' ? data.size() - 1 : data.size();
+    size_t start = 0;
+    size_t pos = end;
+    for (size_t found = 0; found < count; ++found) {
+        const void* newline = memrchr(data.data(), '\n', pos);
+        if (newline == nullptr) {
+            start = 0;
+            break;
+        }
+        pos = static_cast<size_t>(static_cast<const char*>(newline) - data.data());
+        start = pos + 1;
+    }
+
+    while (true) {
+        size_t newline = data.find('\n', start);
+        if (newline == std::string_view::npos || newline >= end) {
+            visit(data.substr(start, end - start));
+            return true;
+        }
+        visit(data.substr(start, newline - start));
+        start = newline + 1;
+    }
+}
+
+bool StatementFile::visitBefore(uint64_t before, size_t count, const NumberedLineVisitor& visit) {
+    if (!mapping_.refresh()) return false;
+    std::string_view data = mapping_.view();
+
+    if (format_ == StatementFormat::Binary) {
+        // Records starting below before; a torn final record is ignored
+        uint64_t available = data.size() / sizeof(StatementRecord);
+        uint64_t end = before == 0 ? 0 : std::min(available, (before - 1) / sizeof(StatementRecord) + 1);
+        std::string line;
+        for (uint64_t i = end - std::min<uint64_t>(count, end); i < end; ++i) {
+            line = formatStatementLine(recordAt(data, i));
+            visit(i * sizeof(StatementRecord), line);
+        }
+        return true;
+    }
+
+    // The last line starting below before ends at the first newline from
+    // before - 1 on (or the end of a final line without one). Walk back
+    // count line starts from there, as visitTail does, so a page costs its
+    // own bytes wherever it is in the statement.
+    uint64_t limit = std::min<uint64_t>(before, data.size());
+    if (limit == 0 || count == 0) return true;
+    size_t end = data.find('\n', static_cast<size_t>(limit - 1));
+    if (end == std::string_view::npos) end = data.size();
+
+    std::vector<size_t> starts;
+    size_t pos = end;
+    while (starts.size() < count) {
+        const void* newline = memrchr(data.data(), '\n', pos);
+        size_t start = newline == nullptr ? 0 : static_cast<size_t>(static_cast<const char*>(newline) - data.data()) + 1;
+        starts.push_back(start);
+        if (start == 0) break;
+        pos = start - 1;
+    }
+    for (auto it = starts.rbegin(); it != starts.rend(); ++it) {
+        size_t lineEnd = data.find('\n', *it);
+        if (lineEnd == std::string_view::npos || lineEnd > end) lineEnd = end;
+        visit(*it, data.substr(*it, lineEnd - *it));
+    }
+    return true;
+}
+
+std::vector<std::string> StatementFile::tail(size_t count) {
+    std::vector<std::string> lines;
+    visitTail(count, [&](std::string_view line) { lines.emplace_back(line); });
+    return lines;
+}
+
+Money StatementFile::lastBalance() {
+    if (format_ == StatementFormat::Binary) {
+        if (!mapping_.refresh()) return Money();
+        std::string_view data = mapping_.view();
+        size_t available = data.size() / sizeof(StatementRecord);
+        if (available == 0) return Money();
+        return Money::fromCents(recordAt(data, available - 1).balanceCents);
+    }
+
+    // CSV format: timestamp,type,amount,balance. Blank or damaged lines at
+    // the end are passed over, so this is the balance of the last line that
+    // parses rather than 0
+    if (!mapping_.refresh()) return Money();
+    std::string_view data = mapping_.view();
+    size_t end = data.size();
+    while (end > 0) {
+        const void* newline = memrchr(data.data(), '\n', end);
+        size_t start = newline == nullptr ? 0 : static_cast<size_t>(static_cast<const char*>(newline) - data.data()) + 1;
+        StatementRecord record;
+        if (start < end && parseStatementLine(data.substr(start, end - start), record)) {
+            return Money::fromCents(record.balanceCents);
+        }
+        if (newline == nullptr) break;
+        end = start - 1;
+    }
+    return Money();
+}
+
+void StatementFile::dropTornTail() const {
+    std::error_code ec;
+    uintmax_t size = fs::file_size(path_, ec);
+    if (ec || size == 0) return;
+
+    uintmax_t keep = size;
+    if (format_ == StatementFormat::Binary) {
+        keep -= size % sizeof(StatementRecord);
+    } else {
+        std::ifstream file(path_, std::ios::binary);
+        char c = '\n';
+        while (keep > 0) {
+            file.seekg(static_cast<std::streamoff>(keep - 1));
+            if (!file.get(c) || c == '\n') break;
+            --keep;
+        }
+    }
+    if (keep != size) {
+        fs::resize_file(path_, keep, ec);
+    }
+}
+
+std::string StatementFile::canonicalLine(const std::string& line) const {
+    StatementRecord record;
+    if (format_ == StatementFormat::Csv || !parseStatementLine(line, record)) {
+        return line;
+    }
+    return formatStatementLine(record);
+}
+
+bool convertStatement(const std::string& fromPath, StatementFormat fromFormat,
+                      const std::string& toPath, StatementFormat toFormat) {
+    std::vector<std::string> lines = StatementFile(fromPath, fromFormat).tail(SIZE_MAX);
+
+    std::string tmpPath = toPath + ".tmp";
+    std::remove(tmpPath.c_str());
+    {
+        // Create the file even for an empty statement
+        std::ofstream create(tmpPath, std::ios::trunc);
+        if (!create.is_open()) return false;
+    }
+    if (!lines.empty() && !StatementFile(tmpPath, toFormat).append(lines)) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return std::rename(tmpPath.c_str(), toPath.c_str()) == 0;
+}
+
+size_t convertAccountStatements(const std::string& dataDir, StatementFormat format) {
+    StatementFormat otherFormat = format == StatementFormat::Binary ? StatementFormat::Csv : StatementFormat::Binary;
+    size_t converted = 0;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dataDir + "/accounts", ec)) {
+        if (!entry.is_directory()) continue;
+        fs::path target = entry.path() / StatementFile::fileName(format);
+        fs::path source = entry.path() / StatementFile::fileName(otherFormat);
+        if (!fs::exists(source)) continue;
+
+        // A target next to its source is a finished conversion whose source
+        // was not removed yet
+        if (!fs::exists(target)) {
+            if (!convertStatement(source.string(), otherFormat, target.string(), format)) continue;
+            ++converted;
+        }
+        fs::remove(source, ec);
+    }
+    return converted;
+}
+
+} // namespace Banking
@@ -0,0 +1,103 @@
+#ifndef STATEMENT_FILE_H
+#define STATEMENT_FILE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include "MappedFile.h"
+#include "Money.h"
+#include "Timestamp.h"
+#include "Transaction.h"
+
+namespace Banking {
+
+enum class StatementFormat {
+    Csv,        // statement.csv: timestamp,type,amount,balance per line
+    Binary      // statement.bin: fixed-width StatementRecords
+};
+
+// One record of a binary statement. Stored in host byte order with no file
+// header, so record i lives at offset i * sizeof(StatementRecord) and the
+// last N records are a single pread from the end of the file.
+struct StatementRecord {
+    int64_t timestamp = 0;      // seconds since the epoch
+    int64_t amountCents = 0;
+    int64_t balanceCents = 0;
+    uint32_t type = 0;          // TransactionType
+    uint16_t milliseconds = 0;
+    uint16_t flags = 0;         // TIMESTAMP_* bits: how the timestamp was written
+};
+static_assert(sizeof(StatementRecord) == 32, "statement records are 32 bytes on disk");
+
+constexpr uint16_t TIMESTAMP_UTC = 1;
+constexpr uint16_t TIMESTAMP_MILLISECONDS = 2;
+
+const char* transactionTypeName(TransactionType type);
+bool parseTransactionType(std::string_view name, TransactionType& type);
+
+// Convert between a CSV statement line and a binary record
+bool parseStatementLine(std::string_view line, StatementRecord& record);
+std::string formatStatementLine(const StatementRecord& record);
+
+// Parse a CSV statement line into a typed transaction. The timestamp is kept
+// as text and only its format is checked, so no time zone conversion runs.
+bool parseStatementLine(std::string_view line, Transaction& transaction);
+
+// An account's statement in either on-disk format. Lines are always exchanged
+// as CSV text; the binary format converts on the way in and out. Reads go
+// through a memory mapping of the file that is kept for the object's
+// lifetime and remapped when the file grows.
+class StatementFile {
+public:
+    using LineVisitor = std::function<void(std::string_view)>;
+    using NumberedLineVisitor = std::function<void(uint64_t offset, std::string_view line)>;
+
+    StatementFile(const std::string& path, StatementFormat format);
+
+    static const char* fileName(StatementFormat format);
+
+    // Append complete lines (without trailing newlines)
+    bool append(const std::vector<std::string>& lines) const;
+
+    // Visit the last count lines, oldest first. CSV lines are views into the
+    // mapping; either kind of view is only valid during the call. False if
+    // the statement cannot be read.
+    bool visitTail(size_t count, const LineVisitor& visit);
+
+    // Visit up to count lines starting below byte offset before, oldest
+    // first, with each line's offset in the file (0 is the first line). The
+    // offsets are the paging cursor: a page is found by walking back from
+    // before, so it costs the page, not the history.
+    bool visitBefore(uint64_t before, size_t count, const NumberedLineVisitor& visit);
+
+    // The last count lines, oldest first
+    std::vector<std::string> tail(size_t count);
+
+    // Balance in the last line that parses, 0 if none does
+    Money lastBalance();
+
+    // Drop a final line or record left partly written by a crash
+    void dropTornTail() const;
+
+    // A line as it reads back after a round trip through this format
+    std::string canonicalLine(const std::string& line) const;
+
+private:
+    std::string path_;
+    StatementFormat format_;
+    MappedFile mapping_;
+};
+
+// Rewrite a statement in the other format (via a temporary file and rename)
+bool convertStatement(const std::string& fromPath, StatementFormat fromFormat,
+                      const std::string& toPath, StatementFormat toFormat);
+
+// Convert every account under dataDir/accounts whose statement is still in
+// the other format; returns the number of statements converted
+size_t convertAccountStatements(const std::string& dataDir, StatementFormat format);
+
+} // namespace Banking
+
+#endif // STATEMENT_FILE_H
@@ -0,0 +1,133 @@
+#include "StaticAsset.h"
+#include "HttpText.h"
+#include <cstdint>
+#include <utility>
+#ifdef BANKING_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace Banking {
+
+namespace {
+// Browsers have to revalidate (the asset URLs are not versioned), which
+// costs a 304 with no body while the ETag still matches
+constexpr const char* CACHE_CONTROL = "no-cache";
+
+std::string gzipCompress(const std::string& content) {
+#ifdef BANKING_HAVE_ZLIB
+    z_stream stream{};
+    // 15 window bits + 16 selects the gzip wrapper
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return "";
+    }
+    std::string compressed(deflateBound(&stream, static_cast<uLong>(content.size())), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(content.data()));
+    stream.avail_in = static_cast<uInt>(content.size());
+    stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+    stream.avail_out = static_cast<uInt>(compressed.size());
+    int status = deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+    return status == Z_STREAM_END ? compressed : "";
+#else
+    (void)content;
+    return "";
+#endif
+}
+
+// Strong validator: FNV-1a over the bytes sent
+std::string makeEtag(const std::string& bytes, const char* suffix) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : bytes) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    static const char* hex = "0123456789abcdef";
+    std::string etag = "\"";
+    for (int shift = 60; shift >= 0; shift -= 4) {
+        etag += hex[(hash >> shift) & 0xf];
+    }
+    etag += suffix;
+    etag += '"';
+    return etag;
+}
+
+// Call visit on each comma-separated element of a header value
+template <typename Visit>
+bool anyListElement(std::string_view list, Visit visit) {
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        if (visit(trim(list.substr(0, comma)))) return true;
+        if (comma == std::string_view::npos) break;
+        list.remove_prefix(comma + 1);
+    }
+    return false;
+}
+}
+
+StaticAsset::StaticAsset(std::string contentType, std::string content)
+    : contentType_(std::move(contentType)), identity_(std::move(content)) {
+    gzip_ = gzipCompress(identity_);
+    if (gzip_.size() >= identity_.size()) {
+        gzip_.clear();
+    }
+    identityEtag_ = makeEtag(identity_, "");
+    if (!gzip_.empty()) {
+        gzipEtag_ = makeEtag(identity_, "-gz");
+    }
+}
+
+bool StaticAsset::isCompressed() const {
+    return !gzip_.empty();
+}
+
+bool StaticAsset::acceptsGzip(std::string_view acceptEncoding) {
+    // "gzip", "gzip;q=0.8", "*"; a q of zero refuses the coding
+    return anyListElement(acceptEncoding, [](std::string_view element) {
+        size_t semicolon = element.find(';');
+        std::string_view coding = trim(element.substr(0, semicolon));
+        if (!equalsIgnoreCase(coding, "gzip") && !equalsIgnoreCase(coding, "x-gzip") && coding != "*") {
+            return false;
+        }
+        if (semicolon == std::string_view::npos) return true;
+        std::string_view params = trim(element.substr(semicolon + 1));
+        if (params.size() < 2 || (params[0] != 'q' && params[0] != 'Q') || params[1] != '=') return true;
+        return params.substr(2).find_first_not_of("0.") != std::string_view::npos;
+    });
+}
+
+bool StaticAsset::etagMatches(std::string_view ifNoneMatch, std::string_view etag) {
+    // If-None-Match uses weak comparison, so a W/ prefix is ignored
+    return anyListElement(ifNoneMatch, [etag](std::string_view candidate) {
+        if (candidate == "*") return true;
+        if (candidate.substr(0, 2) == "W/") candidate.remove_prefix(2);
+        return candidate == etag;
+    });
+}
+
+void StaticAsset::serve(const HttpRequest& request, HttpResponse& response) const {
+    bool gzip = !gzip_.empty() && acceptsGzip(request.header("Accept-Encoding"));
+    const std::string& etag = gzip ? gzipEtag_ : identityEtag_;
+
+    response.headers["ETag"] = etag;
+    response.headers["Cache-Control"] = CACHE_CONTROL;
+    if (!gzip_.empty()) {
+        response.headers["Vary"] = "Accept-Encoding";
+    }
+
+    std::string_view ifNoneMatch = request.header("If-None-Match");
+    if (!ifNoneMatch.empty() && etagMatches(ifNoneMatch, etag)) {
+        response.statusCode = 304;
+        response.statusText = "Not Modified";
+        return;
+    }
+
+    response.headers["Content-Type"] = contentType_;
+    if (gzip) {
+        response.headers["Content-Encoding"] = "gzip";
+        response.staticBody = gzip_;
+    } else {
+        response.staticBody = identity_;
+    }
+}
+
+} // namespace Banking
@@ -0,0 +1,39 @@
+#ifndef STATIC_ASSET_H
+#define STATIC_ASSET_H
+
+#include <string>
+#include <string_view>
+#include "WebServer.h"
+
+namespace Banking {
+
+// A file served verbatim (the embedded UI). The content is gzip-compressed
+// once when the asset is created and each representation gets a strong ETag,
+// so a request costs a header check and, when the client's copy is stale,
+// sending bytes prepared up front. The asset must outlive any response
+// serving it: bodies refer to it rather than copying it.
+class StaticAsset {
+public:
+    StaticAsset(std::string contentType, std::string content);
+
+    // 304 when If-None-Match names the current representation; otherwise the
+    // gzip body if Accept-Encoding allows it, or the identity body
+    void serve(const HttpRequest& request, HttpResponse& response) const;
+
+    // True when a smaller gzip representation is available
+    bool isCompressed() const;
+
+private:
+    std::string contentType_;
+    std::string identity_;
+    std::string gzip_;              // empty when compression is unavailable or not smaller
+    std::string identityEtag_;
+    std::string gzipEtag_;
+
+    static bool acceptsGzip(std::string_view acceptEncoding);
+    static bool etagMatches(std::string_view ifNoneMatch, std::string_view etag);
+};
+
+} // namespace Banking
+
+#endif // STATIC_ASSET_H
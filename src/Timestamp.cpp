@@ -0,0 +1,209 @@
+#include "Timestamp.h"
+#include <chrono>
+#include <climits>
+#include <ctime>
+
+namespace Banking {
+
+namespace {
+constexpr size_t DATE_TIME_LENGTH = 19;     // YYYY-MM-DD HH:MM:SS
+
+struct CivilTime {
+    int year = 0;
+    int month = 0;
+    int day = 0;
+    int hour = 0;
+    int minute = 0;
+    int second = 0;
+};
+
+int64_t floorDiv(int64_t value, int64_t divisor) {
+    int64_t quotient = value / divisor;
+    return (value % divisor < 0) ? quotient - 1 : quotient;
+}
+
+// Days since 1970-01-01 <-> proleptic Gregorian date (H. Hinnant's algorithms)
+void civilFromDays(int64_t days, CivilTime& time) {
+    days += 719468;
+    int64_t era = floorDiv(days, 146097);
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+    time.day = static_cast<int>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+    time.month = static_cast<int>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+    time.year = static_cast<int>(yearOfEra + era * 400 + (time.month <= 2 ? 1 : 0));
+}
+
+int64_t daysFromCivil(int year, int month, int day) {
+    year -= month <= 2 ? 1 : 0;
+    int64_t era = floorDiv(year, 400);
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+CivilTime breakDown(int64_t seconds, bool utc) {
+    CivilTime time;
+    if (utc) {
+        int64_t days = floorDiv(seconds, 86400);
+        int64_t secondOfDay = seconds - days * 86400;
+        civilFromDays(days, time);
+        time.hour = static_cast<int>(secondOfDay / 3600);
+        time.minute = static_cast<int>(secondOfDay / 60 % 60);
+        time.second = static_cast<int>(secondOfDay % 60);
+        return time;
+    }
+
+    std::time_t t = static_cast<std::time_t>(seconds);
+    std::tm local;
+    localtime_r(&t, &local);
+    time.year = local.tm_year + 1900;
+    time.month = local.tm_mon + 1;
+    time.day = local.tm_mday;
+    time.hour = local.tm_hour;
+    time.minute = local.tm_min;
+    time.second = local.tm_sec;
+    return time;
+}
+
+void writeDigits(char* out, int value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+// "YYYY-MM-DD HH:MM:SS", with 'T' as the separator for UTC
+void writeDateTime(char* out, const CivilTime& time, bool utc) {
+    writeDigits(out, time.year, 4);
+    out[4] = '-';
+    writeDigits(out + 5, time.month, 2);
+    out[7] = '-';
+    writeDigits(out + 8, time.day, 2);
+    out[10] = utc ? 'T' : ' ';
+    writeDigits(out + 11, time.hour, 2);
+    out[13] = ':';
+    writeDigits(out + 14, time.minute, 2);
+    out[16] = ':';
+    writeDigits(out + 17, time.second, 2);
+}
+
+void appendFraction(std::string& out, int milliseconds, const TimestampFormat& format) {
+    char tail[5];
+    size_t length = 0;
+    if (format.milliseconds) {
+        tail[length++] = '.';
+        writeDigits(tail + length, milliseconds, 3);
+        length += 3;
+    }
+    if (format.utc) {
+        tail[length++] = 'Z';
+    }
+    out.append(tail, length);
+}
+
+bool readDigits(std::string_view text, size_t pos, size_t width, int& value) {
+    value = 0;
+    for (size_t i = pos; i < pos + width; ++i) {
+        if (text[i] < '0' || text[i] > '9') return false;
+        value = value * 10 + (text[i] - '0');
+    }
+    return true;
+}
+}
+
+void appendCurrentTimestamp(std::string& out, const TimestampFormat& format) {
+    auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+    int64_t millis = std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch).count();
+    int64_t seconds = floorDiv(millis, 1000);
+
+    struct Cache {
+        int64_t second = LLONG_MIN;
+        bool utc = false;
+        char text[DATE_TIME_LENGTH];
+    };
+    thread_local Cache cache;
+    if (cache.second != seconds || cache.utc != format.utc) {
+        writeDateTime(cache.text, breakDown(seconds, format.utc), format.utc);
+        cache.second = seconds;
+        cache.utc = format.utc;
+    }
+
+    out.append(cache.text, DATE_TIME_LENGTH);
+    appendFraction(out, static_cast<int>(millis - seconds * 1000), format);
+}
+
+void appendTimestamp(std::string& out, const TimestampValue& value) {
+    char text[DATE_TIME_LENGTH];
+    writeDateTime(text, breakDown(value.seconds, value.format.utc), value.format.utc);
+    out.append(text, DATE_TIME_LENGTH);
+    appendFraction(out, value.milliseconds, value.format);
+}
+
+namespace {
+// Split text in one of the formats into its fields, without converting it
+bool readTimestamp(std::string_view text, CivilTime& time, int& milliseconds, TimestampFormat& format) {
+    if (text.size() < DATE_TIME_LENGTH || text[4] != '-' || text[7] != '-' || text[13] != ':' || text[16] != ':') {
+        return false;
+    }
+
+    if (!readDigits(text, 0, 4, time.year) || !readDigits(text, 5, 2, time.month) ||
+        !readDigits(text, 8, 2, time.day) || !readDigits(text, 11, 2, time.hour) ||
+        !readDigits(text, 14, 2, time.minute) || !readDigits(text, 17, 2, time.second)) {
+        return false;
+    }
+
+    if (text[10] == 'T') {
+        format.utc = true;
+    } else if (text[10] != ' ') {
+        return false;
+    }
+
+    std::string_view rest = text.substr(DATE_TIME_LENGTH);
+    milliseconds = 0;
+    if (!rest.empty() && rest.front() == '.') {
+        if (rest.size() < 4 || !readDigits(rest, 1, 3, milliseconds)) return false;
+        format.milliseconds = true;
+        rest.remove_prefix(4);
+    }
+    return rest == (format.utc ? "Z" : "");
+}
+}
+
+bool isTimestamp(std::string_view text) {
+    CivilTime time;
+    int milliseconds;
+    TimestampFormat format;
+    return readTimestamp(text, time, milliseconds, format);
+}
+
+bool parseTimestamp(std::string_view text, TimestampValue& value) {
+    CivilTime time;
+    int milliseconds;
+    TimestampFormat format;
+    if (!readTimestamp(text, time, milliseconds, format)) {
+        return false;
+    }
+
+    if (format.utc) {
+        value.seconds = daysFromCivil(time.year, time.month, time.day) * 86400 +
+                        time.hour * 3600 + time.minute * 60 + time.second;
+    } else {
+        std::tm local{};
+        local.tm_year = time.year - 1900;
+        local.tm_mon = time.month - 1;
+        local.tm_mday = time.day;
+        local.tm_hour = time.hour;
+        local.tm_min = time.minute;
+        local.tm_sec = time.second;
+        local.tm_isdst = -1;
+        value.seconds = static_cast<int64_t>(std::mktime(&local));
+    }
+    value.milliseconds = static_cast<uint16_t>(milliseconds);
+    value.format = format;
+    return true;
+}
+
+} // namespace Banking
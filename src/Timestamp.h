@@ -0,0 +1,45 @@
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+namespace Banking {
+
+// How transaction timestamps are written:
+//   local seconds (default)  2026-01-09 10:30:00
+//   local milliseconds       2026-01-09 10:30:00.123
+//   UTC (ISO-8601)           2026-01-09T10:30:00Z
+//   UTC milliseconds         2026-01-09T10:30:00.123Z
+struct TimestampFormat {
+    bool utc = false;
+    bool milliseconds = false;
+};
+
+// Longest text written by the functions below
+constexpr size_t MAX_TIMESTAMP_LENGTH = 24;
+
+// A point in time as stored in binary statements
+struct TimestampValue {
+    int64_t seconds = 0;        // since the epoch
+    uint16_t milliseconds = 0;
+    TimestampFormat format;
+};
+
+// Append the current time. Each thread caches the text for the current
+// second and only reformats it when the second changes.
+void appendCurrentTimestamp(std::string& out, const TimestampFormat& format);
+
+void appendTimestamp(std::string& out, const TimestampValue& value);
+
+// Accepts any of the formats above and reports which one it was
+bool parseTimestamp(std::string_view text, TimestampValue& value);
+
+// Whether text is in one of the formats above. Unlike parseTimestamp it does
+// not convert local times (no mktime, so no time zone lock).
+bool isTimestamp(std::string_view text);
+
+} // namespace Banking
+
+#endif // TIMESTAMP_H
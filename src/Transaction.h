@@ -2,6 +2,8 @@
 #define TRANSACTION_H
 
 #include <string>
+#include <cstdint>
+#include "Money.h"
 
 namespace Banking {
 
@@ -15,10 +17,18 @@ enum class TransactionType {
 };
 
 struct Transaction {
+    uint64_t sequence = 0;      // byte offset in the account's statement, 0 = oldest
     std::string timestamp;
     TransactionType type;
-    double amount;
-    double balance;
+    Money amount;
+    Money balance;
+};
+
+// One operation of a batch: DEPOSIT, DEBIT, or TRANSFER_OUT to toAccountNumber
+struct BatchOperation {
+    TransactionType type;
+    Money amount;
+    std::string toAccountNumber;
 };
 
 } // namespace Banking
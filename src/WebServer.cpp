@@ -1,10 +1,20 @@
 #include "WebServer.h"
+#include "HttpText.h"
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <netinet/in.h>
 #include <unistd.h>
-#include <sstream>
+#include <fcntl.h>
+#include <poll.h>
 #include <iostream>
 #include <cstring>
+#include <cerrno>
+#include <cctype>
+#include <cstdlib>
+#include <string_view>
+#include <algorithm>
+#include <charconv>
 
 namespace Banking {
 
@@ -13,6 +23,12 @@ void HttpResponse::setJson(const std::string& json) {
     body = json;
 }
 
+JsonWriter HttpResponse::writeJson() {
+    headers["Content-Type"] = "application/json";
+    body.clear();
+    return JsonWriter(body);
+}
+
 void HttpResponse::setHtml(const std::string& html) {
     headers["Content-Type"] = "text/html; charset=utf-8";
     body = html;
@@ -28,23 +44,6 @@ void HttpResponse::setJs(const std::string& js) {
     body = js;
 }
 
-namespace {
-std::string escapeJsonString(const std::string& str) {
-    std::string result;
-    for (char c : str) {
-        switch (c) {
-            case '"': result += "\\\""; break;
-            case '\\': result += "\\\\"; break;
-            case '\n': result += "\\n"; break;
-            case '\r': result += "\\r"; break;
-            case '\t': result += "\\t"; break;
-            default: result += c;
-        }
-    }
-    return result;
-}
-}
-
 void HttpResponse::setNotFound() {
     statusCode = 404;
     statusText = "Not Found";
@@ -54,31 +53,138 @@ void HttpResponse::setNotFound() {
 void HttpResponse::setBadRequest(const std::string& message) {
     statusCode = 400;
     statusText = "Bad Request";
-    setJson("{\"error\": \"" + escapeJsonString(message) + "\"}");
+    writeJson().beginObject().key("error").value(message).endObject();
 }
 
 void HttpResponse::setInternalError(const std::string& message) {
     statusCode = 500;
     statusText = "Internal Server Error";
-    setJson("{\"error\": \"" + escapeJsonString(message) + "\"}");
+    writeJson().beginObject().key("error").value(message).endObject();
+}
+
+// Radix tree node. Static nodes match their (compressed) prefix literally;
+// a node reached through paramChild matches one path segment and binds it
+// to paramName.
+struct WebServer::RouteNode {
+    std::string prefix;
+    std::string paramName;
+    std::vector<std::unique_ptr<RouteNode>> children;
+    std::unique_ptr<RouteNode> paramChild;
+    RouteHandler handler;
+};
+
+namespace {
+int methodIndex(std::string_view method) {
+    if (method == "GET") return 0;
+    if (method == "POST") return 1;
+    if (method == "PUT") return 2;
+    if (method == "DELETE") return 3;
+    if (method == "PATCH") return 4;
+    if (method == "HEAD") return 5;
+    if (method == "OPTIONS") return 6;
+    return -1;
 }
 
-WebServer::WebServer(int port) : port_(port), serverSocket_(-1), running_(false) {}
+size_t commonPrefixLength(std::string_view a, std::string_view b) {
+    size_t i = 0;
+    while (i < a.size() && i < b.size() && a[i] == b[i]) ++i;
+    return i;
+}
+}
+
+WebServer::WebServer(int port, int threads)
+    : port_(port), threadCount_(threads), serverSocket_(-1), epollFd_(-1), wakeFd_(-1), running_(false),
+      idleTimeoutSeconds_(5), maxRequestsPerConnection_(100), writeTimeoutMs_(2000),
+      maxHeaderBytes_(16 * 1024), maxBodyBytes_(1024 * 1024) {
+    if (threadCount_ <= 0) {
+        threadCount_ = static_cast<int>(std::thread::hardware_concurrency());
+        if (threadCount_ <= 0) threadCount_ = 1;
+    }
+}
 
 WebServer::~WebServer() {
     stop();
 }
 
 void WebServer::addRoute(const std::string& method, const std::string& path, RouteHandler handler) {
-    routes_[method + " " + path] = handler;
+    int index = methodIndex(method);
+    if (index < 0) {
+        std::cerr << "Unsupported method for route: " << method << "\n";
+        return;
+    }
+    if (!routeTrees_[index]) {
+        routeTrees_[index] = std::make_unique<RouteNode>();
+    }
+    
+    RouteNode* node = routeTrees_[index].get();
+    std::string_view pattern = path;
+    while (!pattern.empty()) {
+        if (pattern.front() == '{') {
+            size_t close = pattern.find('}');
+            if (close == std::string_view::npos) {
+                std::cerr << "Unterminated parameter in route: " << path << "\n";
+                return;
+            }
+            if (!node->paramChild) {
+                node->paramChild = std::make_unique<RouteNode>();
+                node->paramChild->paramName = std::string(pattern.substr(1, close - 1));
+            }
+            node = node->paramChild.get();
+            pattern.remove_prefix(close + 1);
+            continue;
+        }
+        
+        // Insert the static run up to the next parameter, splitting edges as needed
+        std::string_view literal = pattern.substr(0, pattern.find('{'));
+        pattern.remove_prefix(literal.size());
+        while (!literal.empty()) {
+            RouteNode* next = nullptr;
+            for (auto& child : node->children) {
+                size_t common = commonPrefixLength(child->prefix, literal);
+                if (common == 0) continue;
+                if (common < child->prefix.size()) {
+                    auto split = std::make_unique<RouteNode>();
+                    split->prefix = child->prefix.substr(0, common);
+                    child->prefix.erase(0, common);
+                    split->children.push_back(std::move(child));
+                    child = std::move(split);
+                }
+                next = child.get();
+                literal.remove_prefix(common);
+                break;
+            }
+            if (!next) {
+                node->children.push_back(std::make_unique<RouteNode>());
+                next = node->children.back().get();
+                next->prefix = std::string(literal);
+                literal = {};
+            }
+            node = next;
+        }
+    }
+    node->handler = std::move(handler);
 }
 
 void WebServer::setStaticHandler(RouteHandler handler) {
     staticHandler_ = handler;
 }
 
+void WebServer::setKeepAlive(int idleTimeoutSeconds, int maxRequests) {
+    idleTimeoutSeconds_ = idleTimeoutSeconds;
+    maxRequestsPerConnection_ = maxRequests;
+}
+
+void WebServer::setWriteTimeout(int milliseconds) {
+    writeTimeoutMs_ = milliseconds;
+}
+
+void WebServer::setRequestLimits(size_t maxHeaderBytes, size_t maxBodyBytes) {
+    maxHeaderBytes_ = maxHeaderBytes;
+    maxBodyBytes_ = maxBodyBytes;
+}
+
 bool WebServer::start() {
-    serverSocket_ = socket(AF_INET, SOCK_STREAM, 0);
+    serverSocket_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
     if (serverSocket_ < 0) {
         std::cerr << "Failed to create socket\n";
         return false;
@@ -96,30 +202,95 @@ bool WebServer::start() {
     if (bind(serverSocket_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
         std::cerr << "Failed to bind to port " << port_ << "\n";
         close(serverSocket_);
+        serverSocket_ = -1;
         return false;
     }
     
-    if (listen(serverSocket_, 10) < 0) {
+    // Port 0 asks the kernel for a free port; report the one it chose
+    if (port_ == 0) {
+        socklen_t length = sizeof(addr);
+        if (getsockname(serverSocket_, (struct sockaddr*)&addr, &length) == 0) {
+            port_ = ntohs(addr.sin_port);
+        }
+    }
+    
+    if (listen(serverSocket_, SOMAXCONN) < 0) {
         std::cerr << "Failed to listen\n";
         close(serverSocket_);
+        serverSocket_ = -1;
         return false;
     }
     
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd_ < 0 || wakeFd_ < 0) {
+        std::cerr << "Failed to create epoll instance\n";
+        if (epollFd_ >= 0) close(epollFd_);
+        if (wakeFd_ >= 0) close(wakeFd_);
+        close(serverSocket_);
+        serverSocket_ = epollFd_ = wakeFd_ = -1;
+        return false;
+    }
+    
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = serverSocket_;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, serverSocket_, &ev);
+    ev.data.fd = wakeFd_;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+    
     running_ = true;
     serverThread_ = std::thread(&WebServer::serverLoop, this);
+    for (int i = 0; i < threadCount_; ++i) {
+        workers_.emplace_back(&WebServer::workerLoop, this);
+    }
     
-    std::cout << "Server started on http://localhost:" << port_ << "\n";
+    std::cout << "Server started on http://localhost:" << port_
+              << " with " << threadCount_ << " worker thread(s)\n";
     return true;
 }
 
 void WebServer::stop() {
     running_ = false;
+    if (wakeFd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd_, &one, sizeof(one));
+        (void)written;
+    }
+    if (serverThread_.joinable()) {
+        serverThread_.join();
+    }
+    
+    {
+        // Synchronize with workers checking running_ before they wait
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+    }
+    pendingCv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+    
+    // Drop any clients that never reached a worker, then every idle connection
+    while (!pendingClients_.empty()) {
+        pendingClients_.pop();
+    }
+    closeAllConnections();
+    
     if (serverSocket_ >= 0) {
         close(serverSocket_);
         serverSocket_ = -1;
     }
-    if (serverThread_.joinable()) {
-        serverThread_.join();
+    if (epollFd_ >= 0) {
+        close(epollFd_);
+        epollFd_ = -1;
+    }
+    if (wakeFd_ >= 0) {
+        close(wakeFd_);
+        wakeFd_ = -1;
     }
 }
 
@@ -131,158 +302,592 @@ int WebServer::getPort() const {
     return port_;
 }
 
+int WebServer::getThreadCount() const {
+    return threadCount_;
+}
+
 void WebServer::serverLoop() {
+    const int maxEvents = 64;
+    struct epoll_event events[maxEvents];
+    
     while (running_) {
+        // Wake up at least once a second to close idle keep-alive connections
+        int count = epoll_wait(epollFd_, events, maxEvents, 1000);
+        if (count < 0) {
+            if (errno != EINTR) {
+                std::cerr << "epoll_wait failed\n";
+            }
+            continue;
+        }
+        
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd_) {
+                continue;
+            }
+            if (fd == serverSocket_) {
+                acceptClients();
+                continue;
+            }
+            
+            // Connection is readable; it stays disarmed (EPOLLONESHOT) until a
+            // worker releases it
+            Connection* conn = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(connectionsMutex_);
+                auto it = connections_.find(fd);
+                if (it == connections_.end() || it->second->busy) {
+                    continue;
+                }
+                conn = it->second.get();
+                conn->busy = true;
+            }
+            {
+                std::lock_guard<std::mutex> lock(pendingMutex_);
+                pendingClients_.push(conn);
+            }
+            pendingCv_.notify_one();
+        }
+        
+        closeIdleConnections();
+    }
+}
+
+void WebServer::acceptClients() {
+    while (true) {
         struct sockaddr_in clientAddr;
         socklen_t clientLen = sizeof(clientAddr);
         
-        int clientSocket = accept(serverSocket_, (struct sockaddr*)&clientAddr, &clientLen);
+        int clientSocket = accept4(serverSocket_, (struct sockaddr*)&clientAddr, &clientLen,
+                                   SOCK_NONBLOCK | SOCK_CLOEXEC);
         if (clientSocket < 0) {
-            if (running_) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && running_) {
                 std::cerr << "Accept failed\n";
             }
-            continue;
+            return;
         }
         
-        handleClient(clientSocket);
-        close(clientSocket);
+        auto conn = std::make_unique<Connection>();
+        conn->fd = clientSocket;
+        conn->lastActive = std::chrono::steady_clock::now();
+        
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        ev.data.fd = clientSocket;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, clientSocket, &ev) < 0) {
+            close(clientSocket);
+            continue;
+        }
+        connections_[clientSocket] = std::move(conn);
     }
 }
 
-void WebServer::handleClient(int clientSocket) {
-    char buffer[8192];
-    ssize_t bytesRead = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
+void WebServer::closeIdleConnections() {
+    auto now = std::chrono::steady_clock::now();
+    auto timeout = std::chrono::seconds(idleTimeoutSeconds_);
     
-    if (bytesRead <= 0) {
-        return;
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    for (auto it = connections_.begin(); it != connections_.end();) {
+        Connection& conn = *it->second;
+        if (!conn.busy && now - conn.lastActive >= timeout) {
+            epoll_ctl(epollFd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+            close(conn.fd);
+            it = connections_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void WebServer::closeAllConnections() {
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    for (auto& [fd, conn] : connections_) {
+        close(fd);
+    }
+    connections_.clear();
+}
+
+void WebServer::releaseConnection(Connection* conn, bool keepOpen) {
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    if (keepOpen && running_) {
+        conn->busy = false;
+        conn->lastActive = std::chrono::steady_clock::now();
+        
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        ev.data.fd = conn->fd;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_MOD, conn->fd, &ev) == 0) {
+            return;
+        }
     }
     
-    buffer[bytesRead] = '\0';
-    std::string rawRequest(buffer);
+    int fd = conn->fd;
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections_.erase(fd);
+}
+
+void WebServer::workerLoop() {
+    while (true) {
+        Connection* conn;
+        {
+            std::unique_lock<std::mutex> lock(pendingMutex_);
+            pendingCv_.wait(lock, [this] { return !running_ || !pendingClients_.empty(); });
+            if (!running_) {
+                return;
+            }
+            conn = pendingClients_.front();
+            pendingClients_.pop();
+        }
+        
+        bool keepOpen = handleConnection(*conn);
+        releaseConnection(conn, keepOpen);
+    }
+}
+
+WebServer::FrameStatus WebServer::frameRequest(Connection& conn) {
+    if (conn.headerLength == 0) {
+        size_t searchFrom = std::max(conn.readOffset, conn.scanOffset);
+        size_t headerEnd = conn.buffer.find("\r\n\r\n", searchFrom);
+        if (headerEnd == std::string::npos) {
+            if (conn.buffer.size() - conn.readOffset > maxHeaderBytes_) {
+                return FrameStatus::HeaderTooLarge;
+            }
+            // The terminator may straddle the next read, so back up 3 bytes
+            conn.scanOffset = std::max(conn.readOffset, conn.buffer.size() >= 3 ? conn.buffer.size() - 3 : 0);
+            return FrameStatus::Incomplete;
+        }
+        
+        size_t headerLength = headerEnd + 4 - conn.readOffset;
+        if (headerLength > maxHeaderBytes_) {
+            return FrameStatus::HeaderTooLarge;
+        }
+        
+        // Find Content-Length among the header lines (skipping the request line).
+        // Repeats must agree: a body length two parsers could read differently
+        // is how requests get smuggled past a proxy.
+        std::string_view headers(conn.buffer.data() + conn.readOffset, headerLength - 2);
+        size_t contentLength = 0;
+        bool haveContentLength = false;
+        size_t lineStart = headers.find("\r\n") + 2;
+        while (lineStart < headers.size()) {
+            size_t lineEnd = headers.find("\r\n", lineStart);
+            std::string_view line = headers.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 2;
+            
+            size_t colonPos = line.find(':');
+            if (colonPos == std::string_view::npos) continue;
+            std::string_view key = line.substr(0, colonPos);
+            std::string_view value = trim(line.substr(colonPos + 1));
+            
+            if (equalsIgnoreCase(key, "Transfer-Encoding")) {
+                return FrameStatus::Unsupported;
+            }
+            if (equalsIgnoreCase(key, "Content-Length")) {
+                if (value.empty() || value.size() > 18) {
+                    return value.empty() ? FrameStatus::Malformed : FrameStatus::BodyTooLarge;
+                }
+                size_t length = 0;
+                for (char c : value) {
+                    if (c < '0' || c > '9') return FrameStatus::Malformed;
+                    length = length * 10 + static_cast<size_t>(c - '0');
+                }
+                if (haveContentLength && length != contentLength) {
+                    return FrameStatus::Malformed;
+                }
+                contentLength = length;
+                haveContentLength = true;
+            }
+        }
+        if (contentLength > maxBodyBytes_) {
+            return FrameStatus::BodyTooLarge;
+        }
+        
+        conn.headerLength = headerLength;
+        conn.contentLength = contentLength;
+    }
     
-    HttpRequest request = parseRequest(rawRequest);
+    if (conn.buffer.size() - conn.readOffset < conn.headerLength + conn.contentLength) {
+        return FrameStatus::Incomplete;
+    }
+    return FrameStatus::Complete;
+}
+
+void WebServer::rejectRequest(Connection& conn, FrameStatus status) {
     HttpResponse response;
+    switch (status) {
+        case FrameStatus::HeaderTooLarge:
+            response.statusCode = 431;
+            response.statusText = "Request Header Fields Too Large";
+            response.setJson("{\"error\": \"Request headers too large\"}");
+            break;
+        case FrameStatus::BodyTooLarge:
+            response.statusCode = 413;
+            response.statusText = "Payload Too Large";
+            response.setJson("{\"error\": \"Request body too large\"}");
+            break;
+        case FrameStatus::Unsupported:
+            response.statusCode = 501;
+            response.statusText = "Not Implemented";
+            response.setJson("{\"error\": \"Transfer-Encoding is not supported\"}");
+            break;
+        default:
+            response.setBadRequest("Malformed request");
+            break;
+    }
+    sendResponse(conn, response, false);
+}
+
+bool WebServer::handleConnection(Connection& conn) {
+    // Stop reading once a full request's worth of bytes is buffered; the
+    // rest is picked up when the connection is re-armed
+    const size_t readLimit = maxHeaderBytes_ + maxBodyBytes_;
+    char chunk[16384];
+    bool peerClosed = false;
+    while (conn.buffer.size() - conn.readOffset <= readLimit) {
+        ssize_t bytesRead = recv(conn.fd, chunk, sizeof(chunk), 0);
+        if (bytesRead > 0) {
+            conn.buffer.append(chunk, static_cast<size_t>(bytesRead));
+        } else if (bytesRead == 0) {
+            peerClosed = true;
+            break;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else {
+            return false;
+        }
+    }
+    
+    // Serve every complete request already buffered, in order (pipelining)
+    FrameStatus status;
+    while ((status = frameRequest(conn)) == FrameStatus::Complete) {
+        size_t requestLength = conn.headerLength + conn.contentLength;
+        HttpRequest request;
+        bool parsed = parseRequest(std::string_view(conn.buffer.data() + conn.readOffset, requestLength), request);
+        if (!parsed) {
+            rejectRequest(conn, FrameStatus::Malformed);
+            return false;
+        }
+        conn.readOffset += requestLength;
+        conn.scanOffset = conn.readOffset;
+        conn.headerLength = 0;
+        conn.contentLength = 0;
+        conn.requestsServed++;
+        
+        std::string_view connectionHeader = request.header("Connection");
+        bool keepAlive = (request.version == "HTTP/1.1")
+            ? !equalsIgnoreCase(connectionHeader, "close")
+            : equalsIgnoreCase(connectionHeader, "keep-alive");
+        keepAlive = keepAlive && running_ && conn.requestsServed < maxRequestsPerConnection_;
+        
+        HttpResponse response;
+        bool headOnly = request.method == "HEAD";
+        dispatch(request, response);
+        
+        if (!sendResponse(conn, response, keepAlive, headOnly) || !keepAlive) {
+            return false;
+        }
+    }
     
-    // Look for exact route match
-    std::string routeKey = request.method + " " + request.path;
-    auto it = routes_.find(routeKey);
+    if (status != FrameStatus::Incomplete) {
+        rejectRequest(conn, status);
+        return false;
+    }
     
-    if (it != routes_.end()) {
-        it->second(request, response);
+    // Drop handled bytes but keep the buffer's capacity for the next request
+    if (conn.readOffset == conn.buffer.size()) {
+        conn.buffer.clear();
+        conn.scanOffset = 0;
+    } else if (conn.readOffset > 0) {
+        conn.buffer.erase(0, conn.readOffset);
+        conn.scanOffset -= std::min(conn.scanOffset, conn.readOffset);
+    }
+    conn.readOffset = 0;
+    
+    return !peerClosed;
+}
+
+void WebServer::dispatch(HttpRequest& request, HttpResponse& response) {
+    const RouteHandler* handler = findRoute(request);
+    if (handler) {
+        (*handler)(request, response);
     } else if (staticHandler_) {
         staticHandler_(request, response);
     } else {
         response.setNotFound();
     }
+}
+
+// Depth-first match preferring static children over the parameter child;
+// captured values are views into the request path, so nothing is allocated
+const WebServer::RouteHandler* WebServer::matchRoute(const RouteNode* node, std::string_view path,
+                                                     HttpRequest& request) {
+    if (path.empty()) {
+        return node->handler ? &node->handler : nullptr;
+    }
+    for (const auto& child : node->children) {
+        if (path.substr(0, child->prefix.size()) == child->prefix) {
+            if (auto handler = matchRoute(child.get(), path.substr(child->prefix.size()), request)) {
+                return handler;
+            }
+        }
+    }
+    if (node->paramChild && request.pathParamCount < HttpRequest::MAX_PATH_PARAMS) {
+        std::string_view segment = path.substr(0, path.find('/'));
+        if (!segment.empty()) {
+            request.pathParams[request.pathParamCount++] = {node->paramChild->paramName, segment};
+            if (auto handler = matchRoute(node->paramChild.get(), path.substr(segment.size()), request)) {
+                return handler;
+            }
+            request.pathParamCount--;
+        }
+    }
+    return nullptr;
+}
+
+const WebServer::RouteHandler* WebServer::findRoute(HttpRequest& request) const {
+    int index = methodIndex(request.method);
+    if (index < 0) {
+        return nullptr;
+    }
+    const RouteHandler* handler = nullptr;
+    if (routeTrees_[index]) {
+        request.pathParamCount = 0;
+        handler = matchRoute(routeTrees_[index].get(), request.path, request);
+    }
     
-    std::string responseStr = buildResponse(response);
-    send(clientSocket, responseStr.c_str(), responseStr.length(), 0);
+    // HEAD without a route of its own runs the GET handler; sendResponse
+    // then leaves the body out
+    int getIndex = methodIndex("GET");
+    if (!handler && index == methodIndex("HEAD") && routeTrees_[getIndex]) {
+        request.pathParamCount = 0;
+        handler = matchRoute(routeTrees_[getIndex].get(), request.path, request);
+    }
+    return handler;
 }
 
-HttpRequest WebServer::parseRequest(const std::string& rawRequest) {
-    HttpRequest request;
-    std::istringstream stream(rawRequest);
-    std::string line;
+// Head and body go out together in one gathered write; the body is sent
+// from where it lies (the response's own string or a StaticAsset), never
+// copied into an output buffer
+bool WebServer::sendResponse(Connection& conn, const HttpResponse& response, bool keepAlive, bool headOnly) {
+    formatResponseHead(response, keepAlive, conn.responseHead);
     
-    // Parse request line
-    if (std::getline(stream, line)) {
-        // Remove trailing \r if present
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
-        }
-        
-        std::istringstream lineStream(line);
-        std::string pathWithQuery;
-        lineStream >> request.method >> pathWithQuery;
-        
-        // Parse path and query string
-        size_t queryPos = pathWithQuery.find('?');
-        if (queryPos != std::string::npos) {
-            request.path = pathWithQuery.substr(0, queryPos);
-            request.queryParams = parseQueryString(pathWithQuery.substr(queryPos + 1));
+    // 304 and 204 responses have no body, and a reply to HEAD keeps the
+    // Content-Length of the body it leaves out
+    std::string_view body = response.staticBody.empty() ? std::string_view(response.body) : response.staticBody;
+    if (response.statusCode == 304 || response.statusCode == 204 || headOnly) {
+        body = {};
+    }
+    struct iovec parts[2] = {
+        {conn.responseHead.data(), conn.responseHead.size()},
+        {const_cast<char*>(body.data()), body.size()}
+    };
+    return sendAll(conn.fd, parts, body.empty() ? 1 : 2);
+}
+
+// sendmsg() rather than writev() so a closed peer is an EPIPE, not a SIGPIPE.
+// After a short write the parts are advanced past what was sent and the rest
+// is retried; a client that accepts nothing for writeTimeoutMs_ is given up on.
+bool WebServer::sendAll(int clientSocket, struct iovec* parts, size_t count) {
+    while (count > 0) {
+        struct msghdr message = {};
+        message.msg_iov = parts;
+        message.msg_iovlen = count;
+        ssize_t n = sendmsg(clientSocket, &message, MSG_NOSIGNAL);
+        if (n >= 0) {
+            size_t sent = static_cast<size_t>(n);
+            while (count > 0 && sent >= parts->iov_len) {
+                sent -= parts->iov_len;
+                ++parts;
+                --count;
+            }
+            if (count > 0) {
+                parts->iov_base = static_cast<char*>(parts->iov_base) + sent;
+                parts->iov_len -= sent;
+            }
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // Socket buffer is full; wait for the client to drain it
+            struct pollfd pfd = {clientSocket, POLLOUT, 0};
+            if (poll(&pfd, 1, writeTimeoutMs_) <= 0) {
+                return false;
+            }
         } else {
-            request.path = pathWithQuery;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view HttpRequest::header(std::string_view name) const {
+    for (size_t i = 0; i < headerCount; ++i) {
+        if (equalsIgnoreCase(headers[i].name, name)) {
+            return headers[i].value;
+        }
+    }
+    return {};
+}
+
+std::string_view HttpRequest::pathParam(std::string_view name) const {
+    for (size_t i = 0; i < pathParamCount; ++i) {
+        if (pathParams[i].name == name) {
+            return pathParams[i].value;
         }
     }
+    return {};
+}
+
+bool HttpRequest::queryNumber(const std::string& name, uint64_t& value) const {
+    auto it = queryParams.find(name);
+    if (it == queryParams.end()) {
+        return true;
+    }
+    const std::string& text = it->second;
+    uint64_t parsed = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+    if (text.empty() || error != std::errc() || end != text.data() + text.size()) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+bool WebServer::parseRequest(std::string_view rawRequest, HttpRequest& request) {
+    // Request line: METHOD SP TARGET SP VERSION CRLF
+    size_t lineEnd = rawRequest.find("\r\n");
+    if (lineEnd == std::string_view::npos) {
+        return false;
+    }
+    std::string_view requestLine = rawRequest.substr(0, lineEnd);
+    size_t methodEnd = requestLine.find(' ');
+    size_t targetEnd = requestLine.find(' ', methodEnd + 1);
+    if (methodEnd == std::string_view::npos || targetEnd == std::string_view::npos) {
+        return false;
+    }
+    request.method = requestLine.substr(0, methodEnd);
+    std::string_view target = requestLine.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+    request.version = requestLine.substr(targetEnd + 1);
     
-    // Parse headers
-    while (std::getline(stream, line) && line != "\r" && !line.empty()) {
-        if (line.back() == '\r') {
-            line.pop_back();
+    size_t queryPos = target.find('?');
+    request.path = target.substr(0, queryPos);
+    if (queryPos != std::string_view::npos) {
+        parseQueryString(target.substr(queryPos + 1), request.queryParams);
+    }
+    
+    // Header lines up to the blank line
+    request.headerCount = 0;
+    size_t pos = lineEnd + 2;
+    while (true) {
+        lineEnd = rawRequest.find("\r\n", pos);
+        if (lineEnd == std::string_view::npos) {
+            return false;
         }
+        if (lineEnd == pos) {
+            pos += 2;
+            break;
+        }
+        
+        std::string_view line = rawRequest.substr(pos, lineEnd - pos);
+        pos = lineEnd + 2;
         size_t colonPos = line.find(':');
-        if (colonPos != std::string::npos) {
-            std::string key = line.substr(0, colonPos);
-            std::string value = line.substr(colonPos + 1);
-            // Trim leading space from value
-            if (!value.empty() && value[0] == ' ') {
-                value = value.substr(1);
-            }
-            request.headers[key] = value;
+        if (colonPos == std::string_view::npos) {
+            continue;
+        }
+        if (request.headerCount == HttpRequest::MAX_HEADERS) {
+            return false;
         }
+        request.headers[request.headerCount++] = {line.substr(0, colonPos), trim(line.substr(colonPos + 1))};
     }
     
-    // Parse body (rest of the request)
-    std::ostringstream bodyStream;
-    bodyStream << stream.rdbuf();
-    request.body = bodyStream.str();
+    request.body = rawRequest.substr(pos);
     
     // If body is form data, parse it as query params too
-    if (request.headers["Content-Type"] == "application/x-www-form-urlencoded") {
-        auto formParams = parseQueryString(request.body);
-        for (const auto& [key, value] : formParams) {
-            request.queryParams[key] = value;
-        }
+    std::string_view contentType = request.header("Content-Type");
+    if (equalsIgnoreCase(contentType.substr(0, contentType.find(';')), "application/x-www-form-urlencoded")) {
+        parseQueryString(request.body, request.queryParams);
     }
     
-    return request;
+    return true;
+}
+
+namespace {
+void appendNumber(std::string& out, uint64_t value) {
+    char digits[20];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<size_t>(end - digits));
+}
 }
 
-std::string WebServer::buildResponse(const HttpResponse& response) {
-    std::ostringstream stream;
-    stream << "HTTP/1.1 " << response.statusCode << " " << response.statusText << "\r\n";
+// Status line and headers, formatted into head (cleared first, so its
+// capacity carries over from one response on the connection to the next)
+void WebServer::formatResponseHead(const HttpResponse& response, bool keepAlive, std::string& head) const {
+    head.clear();
+    head += "HTTP/1.1 ";
+    appendNumber(head, static_cast<uint64_t>(response.statusCode));
+    head += ' ';
+    head += response.statusText;
+    head += "\r\n";
     
     for (const auto& [key, value] : response.headers) {
-        stream << key << ": " << value << "\r\n";
+        head += key;
+        head += ": ";
+        head += value;
+        head += "\r\n";
     }
     
-    stream << "Content-Length: " << response.body.length() << "\r\n";
-    stream << "Connection: close\r\n";
-    stream << "\r\n";
-    stream << response.body;
-    
-    return stream.str();
+    // 304 and 204 responses have no body and no Content-Length
+    if (response.statusCode != 304 && response.statusCode != 204) {
+        head += "Content-Length: ";
+        appendNumber(head, response.staticBody.empty() ? response.body.size() : response.staticBody.size());
+        head += "\r\n";
+    }
+    if (keepAlive) {
+        head += "Connection: keep-alive\r\nKeep-Alive: timeout=";
+        appendNumber(head, static_cast<uint64_t>(idleTimeoutSeconds_));
+        head += ", max=";
+        appendNumber(head, static_cast<uint64_t>(maxRequestsPerConnection_));
+        head += "\r\n";
+    } else {
+        head += "Connection: close\r\n";
+    }
+    head += "\r\n";
 }
 
-std::map<std::string, std::string> WebServer::parseQueryString(const std::string& query) {
-    std::map<std::string, std::string> params;
-    std::istringstream stream(query);
-    std::string pair;
-    
-    while (std::getline(stream, pair, '&')) {
+void WebServer::parseQueryString(std::string_view query, std::map<std::string, std::string>& params) {
+    while (!query.empty()) {
+        size_t ampPos = query.find('&');
+        std::string_view pair = query.substr(0, ampPos);
+        query = (ampPos == std::string_view::npos) ? std::string_view() : query.substr(ampPos + 1);
+        
         size_t eqPos = pair.find('=');
-        if (eqPos != std::string::npos) {
-            std::string key = urlDecode(pair.substr(0, eqPos));
-            std::string value = urlDecode(pair.substr(eqPos + 1));
-            params[key] = value;
+        if (eqPos != std::string_view::npos) {
+            params[urlDecode(pair.substr(0, eqPos))] = urlDecode(pair.substr(eqPos + 1));
         }
     }
-    
-    return params;
 }
 
-std::string WebServer::urlDecode(const std::string& str) {
+namespace {
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+}
+
+std::string WebServer::urlDecode(std::string_view str) {
     std::string result;
+    result.reserve(str.size());
     for (size_t i = 0; i < str.length(); ++i) {
-        if (str[i] == '%' && i + 2 < str.length()) {
-            int value;
-            std::istringstream iss(str.substr(i + 1, 2));
-            if (iss >> std::hex >> value) {
-                result += static_cast<char>(value);
-                i += 2;
-            } else {
-                result += str[i];
-            }
+        if (str[i] == '%' && i + 2 < str.length() && hexValue(str[i + 1]) >= 0 && hexValue(str[i + 2]) >= 0) {
+            result += static_cast<char>(hexValue(str[i + 1]) * 16 + hexValue(str[i + 2]));
+            i += 2;
         } else if (str[i] == '+') {
             result += ' ';
         } else {
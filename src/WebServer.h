@@ -2,19 +2,63 @@
 #define WEBSERVER_H
 
 #include <string>
+#include <string_view>
+#include <array>
+#include <cstdint>
 #include <map>
+#include <unordered_map>
+#include <memory>
+#include <chrono>
 #include <functional>
 #include <thread>
 #include <atomic>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <sys/uio.h>
+#include "JsonWriter.h"
 
 namespace Banking {
 
+struct HttpHeader {
+    std::string_view name;
+    std::string_view value;
+};
+
+struct HttpPathParam {
+    std::string_view name;
+    std::string_view value;
+};
+
+// Method, path, headers and body are views into the connection buffer and are
+// only valid while the request is being handled
 struct HttpRequest {
-    std::string method;
-    std::string path;
-    std::map<std::string, std::string> headers;
-    std::string body;
+    static constexpr size_t MAX_HEADERS = 64;
+    static constexpr size_t MAX_PATH_PARAMS = 8;
+    
+    std::string_view method;
+    std::string_view path;
+    std::string_view version;
+    std::array<HttpHeader, MAX_HEADERS> headers;
+    size_t headerCount = 0;
+    std::string_view body;
     std::map<std::string, std::string> queryParams;
+    
+    // Values captured by {name} segments of the matched route
+    std::array<HttpPathParam, MAX_PATH_PARAMS> pathParams;
+    size_t pathParamCount = 0;
+    
+    // Case-insensitive header lookup; empty if the header is absent
+    std::string_view header(std::string_view name) const;
+    
+    // Path parameter lookup; empty if the route has no such parameter
+    std::string_view pathParam(std::string_view name) const;
+    
+    // Query parameter as an unsigned decimal number. value is left alone if
+    // the parameter is absent; false if it is present but not all digits or
+    // out of range.
+    bool queryNumber(const std::string& name, uint64_t& value) const;
 };
 
 struct HttpResponse {
@@ -23,7 +67,14 @@ struct HttpResponse {
     std::map<std::string, std::string> headers;
     std::string body;
     
+    // Sent instead of body when set: content that outlives the response,
+    // such as a StaticAsset, and is not copied into it
+    std::string_view staticBody;
+    
     void setJson(const std::string& json);
+    
+    // Set the JSON content type and return a writer that builds the body in place
+    JsonWriter writeJson();
     void setHtml(const std::string& html);
     void setCss(const std::string& css);
     void setJs(const std::string& js);
@@ -36,32 +87,107 @@ class WebServer {
 public:
     using RouteHandler = std::function<void(const HttpRequest&, HttpResponse&)>;
     
-    explicit WebServer(int port = 8080);
+    // threads: number of worker threads handling requests (0 = one per CPU core);
+    // port 0 takes any free port, which getPort() reports once started
+    explicit WebServer(int port = 8080, int threads = 0);
     ~WebServer();
     
+    // path may contain {name} segments, e.g. /api/accounts/{id}/statement;
+    // static segments take precedence over parameters
     void addRoute(const std::string& method, const std::string& path, RouteHandler handler);
     void setStaticHandler(RouteHandler handler);
     
+    // Keep-alive: idle connections are closed after idleTimeoutSeconds, and a
+    // connection is closed after serving maxRequests requests
+    void setKeepAlive(int idleTimeoutSeconds, int maxRequests);
+    
+    // A response write that makes no progress for this long (the client is
+    // not reading) is abandoned and the connection closed, freeing the worker
+    void setWriteTimeout(int milliseconds);
+    
+    // Requests whose header block or body exceed these sizes are rejected
+    // with 431 / 413 and the connection is closed
+    void setRequestLimits(size_t maxHeaderBytes, size_t maxBodyBytes);
+    
     bool start();
     void stop();
     bool isRunning() const;
     int getPort() const;
+    int getThreadCount() const;
+    
+    // Parse one complete request; returns false if it is malformed
+    static bool parseRequest(std::string_view rawRequest, HttpRequest& request);
 
 private:
+    struct RouteNode;
+    static constexpr size_t METHOD_COUNT = 7;
+    
+    enum class FrameStatus {
+        Incomplete,
+        Complete,
+        HeaderTooLarge,
+        BodyTooLarge,
+        Malformed,
+        Unsupported
+    };
+    
+    struct Connection {
+        int fd = -1;
+        std::string buffer;         // received bytes; [readOffset, size) not yet handled
+        size_t readOffset = 0;
+        size_t scanOffset = 0;      // where to resume searching for the end of headers
+        size_t headerLength = 0;    // 0 until the current request's headers are complete
+        size_t contentLength = 0;
+        int requestsServed = 0;
+        std::string responseHead;   // status line and headers of the reply being sent, reused
+        bool busy = false;          // owned by a worker, not armed in epoll
+        std::chrono::steady_clock::time_point lastActive;
+    };
+    
     int port_;
+    int threadCount_;
     int serverSocket_;
+    int epollFd_;
+    int wakeFd_;
     std::atomic<bool> running_;
     std::thread serverThread_;
+    std::vector<std::thread> workers_;
+    int idleTimeoutSeconds_;
+    int maxRequestsPerConnection_;
+    int writeTimeoutMs_;
+    size_t maxHeaderBytes_;
+    size_t maxBodyBytes_;
+    
+    // Open client connections, keyed by socket
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+    std::mutex connectionsMutex_;
+    
+    // Connections that are ready to read, waiting for a worker
+    std::queue<Connection*> pendingClients_;
+    std::mutex pendingMutex_;
+    std::condition_variable pendingCv_;
     
-    std::map<std::string, RouteHandler> routes_;
+    // One radix tree of path patterns per HTTP method
+    std::array<std::unique_ptr<RouteNode>, METHOD_COUNT> routeTrees_;
     RouteHandler staticHandler_;
     
     void serverLoop();
-    void handleClient(int clientSocket);
-    HttpRequest parseRequest(const std::string& rawRequest);
-    std::string buildResponse(const HttpResponse& response);
-    std::map<std::string, std::string> parseQueryString(const std::string& query);
-    std::string urlDecode(const std::string& str);
+    void workerLoop();
+    void acceptClients();
+    void closeIdleConnections();
+    void closeAllConnections();
+    void releaseConnection(Connection* conn, bool keepOpen);
+    bool handleConnection(Connection& conn);
+    FrameStatus frameRequest(Connection& conn);
+    void rejectRequest(Connection& conn, FrameStatus status);
+    void dispatch(HttpRequest& request, HttpResponse& response);
+    const RouteHandler* findRoute(HttpRequest& request) const;
+    static const RouteHandler* matchRoute(const RouteNode* node, std::string_view path, HttpRequest& request);
+    bool sendResponse(Connection& conn, const HttpResponse& response, bool keepAlive, bool headOnly = false);
+    bool sendAll(int clientSocket, struct iovec* parts, size_t count);
+    void formatResponseHead(const HttpResponse& response, bool keepAlive, std::string& head) const;
+    static void parseQueryString(std::string_view query, std::map<std::string, std::string>& params);
+    static std::string urlDecode(std::string_view str);
 };
 
 } // namespace Banking
@@ -16,7 +16,8 @@ void printHelp() {
     std::cout << "  debit <session_id> <amount>          - Withdraw money\n";
     std::cout << "  transfer <session_id> <to_account> <amount> - Transfer money to another account\n";
     std::cout << "  statement <session_id> [lines]       - View account statement\n";
-    std::cout << "  list_accounts <session_id>           - List all accounts (admin only)\n";
+    std::cout << "  list_accounts <session_id> [after] [limit] - List accounts, one page at a time (admin only)\n";
+    std::cout << "  session_stats <session_id>           - Show session counters (admin only)\n";
     std::cout << "  help                                 - Show this help\n";
     std::cout << "  exit                                 - Exit application\n";
     std::cout << "\n";
@@ -95,42 +96,36 @@ int main() {
                 std::cout << "error: usage: deposit <session_id> <amount>\n";
                 continue;
             }
-            try {
-                double amount = std::stod(tokens[2]);
-                std::cout << bank.deposit(tokens[1], amount) << "\n";
-            } catch (const std::invalid_argument&) {
+            Banking::Money amount;
+            if (!Banking::Money::parse(tokens[2], amount)) {
                 std::cout << "error: invalid amount format\n";
-            } catch (const std::out_of_range&) {
-                std::cout << "error: amount out of range\n";
+                continue;
             }
+            std::cout << bank.deposit(tokens[1], amount) << "\n";
         }
         else if (cmd == "debit") {
             if (tokens.size() < 3) {
                 std::cout << "error: usage: debit <session_id> <amount>\n";
                 continue;
             }
-            try {
-                double amount = std::stod(tokens[2]);
-                std::cout << bank.debit(tokens[1], amount) << "\n";
-            } catch (const std::invalid_argument&) {
+            Banking::Money amount;
+            if (!Banking::Money::parse(tokens[2], amount)) {
                 std::cout << "error: invalid amount format\n";
-            } catch (const std::out_of_range&) {
-                std::cout << "error: amount out of range\n";
+                continue;
             }
+            std::cout << bank.debit(tokens[1], amount) << "\n";
         }
         else if (cmd == "transfer") {
             if (tokens.size() < 4) {
                 std::cout << "error: usage: transfer <session_id> <to_account> <amount>\n";
                 continue;
             }
-            try {
-                double amount = std::stod(tokens[3]);
-                std::cout << bank.transfer(tokens[1], tokens[2], amount) << "\n";
-            } catch (const std::invalid_argument&) {
+            Banking::Money amount;
+            if (!Banking::Money::parse(tokens[3], amount)) {
                 std::cout << "error: invalid amount format\n";
-            } catch (const std::out_of_range&) {
-                std::cout << "error: amount out of range\n";
+                continue;
             }
+            std::cout << bank.transfer(tokens[1], tokens[2], amount) << "\n";
         }
         else if (cmd == "statement") {
             if (tokens.size() < 2) {
@@ -151,10 +146,28 @@ int main() {
         }
         else if (cmd == "list_accounts") {
             if (tokens.size() < 2) {
-                std::cout << "error: usage: list_accounts <session_id>\n";
+                std::cout << "error: usage: list_accounts <session_id> [after] [limit]\n";
+                continue;
+            }
+            std::string after = tokens.size() >= 3 ? tokens[2] : "";
+            size_t limit = Banking::ACCOUNTS_PAGE_SIZE;
+            if (tokens.size() >= 4) {
+                try {
+                    limit = std::stoul(tokens[3]);
+                } catch (const std::invalid_argument&) {
+                    std::cout << "warning: invalid limit parameter, using default\n";
+                } catch (const std::out_of_range&) {
+                    std::cout << "warning: limit parameter out of range, using default\n";
+                }
+            }
+            std::cout << bank.listAccounts(tokens[1], after, limit);
+        }
+        else if (cmd == "session_stats") {
+            if (tokens.size() < 2) {
+                std::cout << "error: usage: session_stats <session_id>\n";
                 continue;
             }
-            std::cout << bank.listAccounts(tokens[1]);
+            std::cout << bank.getSessionStats(tokens[1]);
         }
         else {
             std::cout << "error: unknown command '" << cmd << "'. Type 'help' for available commands.\n";
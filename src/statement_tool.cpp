@@ -0,0 +1,55 @@
+#include <iostream>
+#include <string>
+#include <filesystem>
+#include "StatementFile.h"
+
+namespace fs = std::filesystem;
+
+void printHelp(const char* program) {
+    std::cout << "Statement conversion tool\n";
+    std::cout << "Usage:\n";
+    std::cout << "  " << program << " import <statement.csv> <statement.bin>  - CSV to binary\n";
+    std::cout << "  " << program << " export <statement.bin> <statement.csv>  - Binary to CSV\n";
+    std::cout << "  " << program << " convert <data_dir> <csv|binary>         - Convert every account\n";
+    std::cout << "\n";
+    std::cout << "Stop the bank before converting its data directory.\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 4) {
+        printHelp(argv[0]);
+        return 1;
+    }
+
+    std::string command = argv[1];
+    if (command == "import" || command == "export") {
+        bool toBinary = command == "import";
+        Banking::StatementFormat from = toBinary ? Banking::StatementFormat::Csv : Banking::StatementFormat::Binary;
+        Banking::StatementFormat to = toBinary ? Banking::StatementFormat::Binary : Banking::StatementFormat::Csv;
+        if (!fs::exists(argv[2])) {
+            std::cout << "error: " << argv[2] << " not found\n";
+            return 1;
+        }
+        if (!Banking::convertStatement(argv[2], from, argv[3], to)) {
+            std::cout << "error: could not convert " << argv[2] << "\n";
+            return 1;
+        }
+        std::cout << "ok\n";
+        return 0;
+    }
+
+    if (command == "convert") {
+        std::string format = argv[3];
+        if (format != "csv" && format != "binary") {
+            std::cout << "error: format must be csv or binary\n";
+            return 1;
+        }
+        size_t converted = Banking::convertAccountStatements(
+            argv[2], format == "binary" ? Banking::StatementFormat::Binary : Banking::StatementFormat::Csv);
+        std::cout << "converted " << converted << " statements\n";
+        return 0;
+    }
+
+    printHelp(argv[0]);
+    return 1;
+}
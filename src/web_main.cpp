@@ -1,45 +1,101 @@
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <signal.h>
 #include "Bank.h"
+#include "JsonWriter.h"
+#include "StaticAsset.h"
 #include "WebServer.h"
 
-// Global server pointer for signal handling
-Banking::WebServer* g_server = nullptr;
+// Set by the signal handler, which may only do async-signal-safe work;
+// main sees it and stops the server
+volatile sig_atomic_t g_stopRequested = 0;
 
-void signalHandler(int signum) {
-    std::cout << "\nShutting down server...\n";
-    if (g_server) {
-        g_server->stop();
+void signalHandler(int) {
+    g_stopRequested = 1;
+}
+
+// {"success":...,"message":...[,"data":...]}, written into the response body
+void writeJsonResponse(Banking::HttpResponse& res, bool success, std::string_view message,
+                       std::string_view data = {}) {
+    Banking::JsonWriter json = res.writeJson();
+    json.beginObject()
+        .key("success").value(success)
+        .key("message").value(message);
+    if (!data.empty()) {
+        json.key("data").value(data);
     }
+    json.endObject();
 }
 
-// Simple JSON helper functions
-std::string jsonEscape(const std::string& str) {
-    std::string result;
-    for (char c : str) {
-        switch (c) {
-            case '"': result += "\\\""; break;
-            case '\\': result += "\\\\"; break;
-            case '\n': result += "\\n"; break;
-            case '\r': result += "\\r"; break;
-            case '\t': result += "\\t"; break;
-            default: result += c;
-        }
+// Amounts are written as JSON numbers with exactly two decimals
+void writeAmount(Banking::JsonWriter& json, Banking::Money amount) {
+    char text[Banking::Money::MAX_TEXT_LENGTH];
+    json.rawValue(std::string_view(text, amount.format(text)));
+}
+
+// {"success":true,"message":...,"data":[{seq,ts,type,amount,balance}...],"next":seq}
+void writeTransactionsResponse(Banking::HttpResponse& res, const std::vector<Banking::Transaction>& transactions,
+                               uint64_t next) {
+    res.body.reserve(64 + transactions.size() * 112);
+    Banking::JsonWriter json = res.writeJson();
+    json.beginObject()
+        .key("success").value(true)
+        .key("message").value("Transactions retrieved")
+        .key("data").beginArray();
+    for (const auto& transaction : transactions) {
+        json.beginObject()
+            .key("seq").value(transaction.sequence)
+            .key("ts").value(transaction.timestamp)
+            .key("type").value(Banking::transactionTypeName(transaction.type))
+            .key("amount");
+        writeAmount(json, transaction.amount);
+        json.key("balance");
+        writeAmount(json, transaction.balance);
+        json.endObject();
+    }
+    json.endArray();
+    if (next > 0) {
+        json.key("next").value(next);
     }
-    return result;
+    json.endObject();
 }
 
-std::string makeJsonResponse(bool success, const std::string& message, const std::string& data = "") {
-    std::ostringstream json;
-    json << "{\"success\":" << (success ? "true" : "false") 
-         << ",\"message\":\"" << jsonEscape(message) << "\"";
-    if (!data.empty()) {
-        json << ",\"data\":\"" << jsonEscape(data) << "\"";
+// One batch operation per line: "deposit <amount>", "debit <amount>" or
+// "transfer <to_account> <amount>"
+bool parseBatchOperation(const std::string& line, Banking::BatchOperation& operation) {
+    std::istringstream tokens(line);
+    std::string command;
+    std::string amount;
+    std::string extra;
+    tokens >> command;
+    if (command == "deposit" || command == "debit") {
+        operation.type = command == "deposit" ? Banking::TransactionType::DEPOSIT : Banking::TransactionType::DEBIT;
+        tokens >> amount;
+    } else if (command == "transfer") {
+        operation.type = Banking::TransactionType::TRANSFER_OUT;
+        tokens >> operation.toAccountNumber >> amount;
+    } else {
+        return false;
     }
-    json << "}";
-    return json.str();
+    return Banking::Money::parse(amount, operation.amount) && !(tokens >> extra);
+}
+
+void writeBatchResponse(Banking::HttpResponse& res, const std::string& result, const std::vector<std::string>& results) {
+    bool success = result == "ok";
+    Banking::JsonWriter json = res.writeJson();
+    json.beginObject()
+        .key("success").value(success)
+        .key("message").value(success ? std::string_view("Batch applied") : std::string_view(result))
+        .key("results").beginArray();
+    for (const auto& itemResult : results) {
+        json.beginObject()
+            .key("success").value(itemResult == "ok")
+            .key("message").value(itemResult)
+            .endObject();
+    }
+    json.endArray().endObject();
 }
 
 // HTML content for the banking UI
@@ -173,6 +229,7 @@ const char* getHtmlContent() {
                     <h3>📋 Bank Status</h3>
                     <pre id="bank-status"></pre>
                     <button onclick="listAccounts()" class="btn btn-secondary">Refresh Status</button>
+                    <button id="accounts-next" onclick="listAccounts(accountsCursor)" class="btn btn-secondary hidden">Next Page</button>
                 </div>
             </div>
         </section>
@@ -576,28 +633,23 @@ async function transfer(event) {
 
 // Get statement
 async function refreshStatement() {
-    const result = await api('/api/statement', { session_id: sessionId, lines: 10 });
+    const result = await api('/api/transactions', { session_id: sessionId, limit: 10 });
     
     if (result.success) {
-        const lines = result.data.split('\n').filter(line => line.trim());
         statementBody.innerHTML = '';
         
         let lastBalance = 0;
         
-        // Skip header line
-        for (let i = 1; i < lines.length; i++) {
-            const parts = lines[i].split(',');
-            if (parts.length >= 4) {
-                const row = document.createElement('tr');
-                row.innerHTML = `
-                    <td>${parts[0]}</td>
-                    <td>${parts[1]}</td>
-                    <td>$${parseFloat(parts[2]).toFixed(2)}</td>
-                    <td>$${parseFloat(parts[3]).toFixed(2)}</td>
-                `;
-                statementBody.appendChild(row);
-                lastBalance = parseFloat(parts[3]);
-            }
+        for (const transaction of result.data) {
+            const row = document.createElement('tr');
+            row.innerHTML = `
+                <td>${transaction.ts}</td>
+                <td>${transaction.type}</td>
+                <td>$${transaction.amount.toFixed(2)}</td>
+                <td>$${transaction.balance.toFixed(2)}</td>
+            `;
+            statementBody.appendChild(row);
+            lastBalance = transaction.balance;
         }
         
         balanceDisplay.textContent = `$${lastBalance.toFixed(2)}`;
@@ -628,12 +680,17 @@ async function createAccount(event) {
     }
 }
 
-// List accounts (admin)
-async function listAccounts() {
-    const result = await api('/api/list_accounts', { session_id: sessionId });
+// List accounts (admin), one page at a time
+let accountsCursor = '';
+
+async function listAccounts(after = '') {
+    const result = await api('/api/list_accounts', { session_id: sessionId, after: after });
     
     if (result.success) {
         bankStatus.textContent = result.data;
+        const next = result.data.match(/^Next: (\d+)$/m);
+        accountsCursor = next ? next[1] : '';
+        document.getElementById('accounts-next').classList.toggle('hidden', !next);
     } else {
         showMessage(result.message, true);
     }
@@ -643,7 +700,12 @@ async function listAccounts() {
 
 int main(int argc, char* argv[]) {
     int port = 8080;
+    int threads = 0;
     std::string dataDir = "data";
+    Banking::SessionConfig sessionConfig;
+    Banking::StatementFormat statementFormat = Banking::StatementFormat::Csv;
+    Banking::TimestampFormat timestampFormat;
+    Banking::CredentialConfig credentialConfig;
     
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -652,12 +714,47 @@ int main(int argc, char* argv[]) {
             port = std::stoi(argv[++i]);
         } else if (arg == "--data" && i + 1 < argc) {
             dataDir = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::stoi(argv[++i]);
+        } else if (arg == "--persist-sessions") {
+            sessionConfig.persistSnapshot = true;
+        } else if (arg == "--session-ttl" && i + 1 < argc) {
+            sessionConfig.absoluteTtl = std::chrono::seconds(std::stoi(argv[++i]));
+        } else if (arg == "--session-idle" && i + 1 < argc) {
+            sessionConfig.idleTtl = std::chrono::seconds(std::stoi(argv[++i]));
+        } else if (arg == "--max-sessions" && i + 1 < argc) {
+            sessionConfig.maxSessions = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--statement-format" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format != "csv" && format != "binary") {
+                std::cerr << "Unknown statement format: " << format << "\n";
+                return 1;
+            }
+            statementFormat = format == "binary" ? Banking::StatementFormat::Binary : Banking::StatementFormat::Csv;
+        } else if (arg == "--utc-timestamps") {
+            timestampFormat.utc = true;
+        } else if (arg == "--ms-timestamps") {
+            timestampFormat.milliseconds = true;
+        } else if (arg == "--pin-work-factor" && i + 1 < argc) {
+            credentialConfig.workFactor = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--login-threads" && i + 1 < argc) {
+            credentialConfig.verifyThreads = static_cast<size_t>(std::stoul(argv[++i]));
         } else if (arg == "--help") {
             std::cout << "Banking Web Server\n";
             std::cout << "Usage: " << argv[0] << " [options]\n";
             std::cout << "Options:\n";
             std::cout << "  --port <port>  Port to listen on (default: 8080)\n";
             std::cout << "  --data <dir>   Data directory (default: data)\n";
+            std::cout << "  --threads <n>  Worker threads (default: one per CPU core)\n";
+            std::cout << "  --persist-sessions  Keep sessions across restarts (snapshot file)\n";
+            std::cout << "  --session-ttl <s>   Session lifetime after login (default: 28800)\n";
+            std::cout << "  --session-idle <s>  Session idle timeout (default: 1800)\n";
+            std::cout << "  --max-sessions <n>  Cap on live sessions (default: 100000)\n";
+            std::cout << "  --statement-format <csv|binary>  On-disk statement format (default: csv)\n";
+            std::cout << "  --utc-timestamps    Write transaction times as UTC ISO-8601\n";
+            std::cout << "  --ms-timestamps     Write transaction times with milliseconds\n";
+            std::cout << "  --pin-work-factor <n>  PBKDF2 iterations for new PIN hashes (default: 20000)\n";
+            std::cout << "  --login-threads <n>    Threads verifying PINs at login (default: 2)\n";
             std::cout << "  --help         Show this help\n";
             return 0;
         }
@@ -667,12 +764,18 @@ int main(int argc, char* argv[]) {
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
     
+    // A login holds its HTTP worker until the PIN is verified, so fewer
+    // logins may wait than there are workers; the rest fail at once, and
+    // with two or more workers one is always left for transactions
+    int httpThreads = threads > 0 ? threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    credentialConfig.maxPendingVerifications =
+        std::max<size_t>(1, std::min(credentialConfig.verifyThreads * 2, static_cast<size_t>(httpThreads - 1)));
+    
     // Create bank instance
-    Banking::Bank bank(dataDir);
+    Banking::Bank bank(dataDir, sessionConfig, statementFormat, timestampFormat, credentialConfig);
     
     // Create web server
-    Banking::WebServer server(port);
-    g_server = &server;
+    Banking::WebServer server(port, threads);
     
     // API Routes
     server.addRoute("GET", "/api/login", [&bank](const Banking::HttpRequest& req, Banking::HttpResponse& res) {
@@ -680,29 +783,29 @@ int main(int argc, char* argv[]) {
         auto it_pin = req.queryParams.find("pin");
         
         if (it_account == req.queryParams.end() || it_pin == req.queryParams.end()) {
-            res.setJson(makeJsonResponse(false, "Missing account or pin"));
+            writeJsonResponse(res, false, "Missing account or pin");
             return;
         }
         
         std::string sessionId = bank.login(it_account->second, it_pin->second);
         if (sessionId.empty()) {
-            res.setJson(makeJsonResponse(false, "Invalid account or pin"));
+            writeJsonResponse(res, false, "Invalid account or pin");
         } else {
-            res.setJson(makeJsonResponse(true, "Login successful", sessionId));
+            writeJsonResponse(res, true, "Login successful", sessionId);
         }
     });
     
     server.addRoute("GET", "/api/logout", [&bank](const Banking::HttpRequest& req, Banking::HttpResponse& res) {
         auto it = req.queryParams.find("session_id");
         if (it == req.queryParams.end()) {
-            res.setJson(makeJsonResponse(false, "Missing session_id"));
+            writeJsonResponse(res, false, "Missing session_id");
             return;
         }
         
         if (bank.logout(it->second)) {
-            res.setJson(makeJsonResponse(true, "Logged out"));
+            writeJsonResponse(res, true, "Logged out");
         } else {
-            res.setJson(makeJsonResponse(false, "Invalid session"));
+            writeJsonResponse(res, false, "Invalid session");
         }
     });
     
@@ -711,20 +814,21 @@ int main(int argc, char* argv[]) {
         auto it_amount = req.queryParams.find("amount");
         
         if (it_session == req.queryParams.end() || it_amount == req.queryParams.end()) {
-            res.setJson(makeJsonResponse(false, "Missing session_id or amount"));
+            writeJsonResponse(res, false, "Missing session_id or amount");
             return;
         }
         
-        try {
-            double amount = std::stod(it_amount->second);
-            std::string result = bank.deposit(it_session->second, amount);
-            if (result == "ok") {
-                res.setJson(makeJsonResponse(true, "Deposit successful"));
-            } else {
-                res.setJson(makeJsonResponse(false, result));
-            }
-        } catch (...) {
-            res.setJson(makeJsonResponse(false, "Invalid amount"));
+        Banking::Money amount;
+        if (!Banking::Money::parse(it_amount->second, amount)) {
+            writeJsonResponse(res, false, "Invalid amount");
+            return;
+        }
+        
+        std::string result = bank.deposit(it_session->second, amount);
+        if (result == "ok") {
+            writeJsonResponse(res, true, "Deposit successful");
+        } else {
+            writeJsonResponse(res, false, result);
         }
     });
     
@@ -733,20 +837,21 @@ int main(int argc, char* argv[]) {
         auto it_amount = req.queryParams.find("amount");
         
         if (it_session == req.queryParams.end() || it_amount == req.queryParams.end()) {
-            res.setJson(makeJsonResponse(false, "Missing session_id or amount"));
+            writeJsonResponse(res, false, "Missing session_id or amount");
             return;
         }
         
-        try {
-            double amount = std::stod(it_amount->second);
-            std::string result = bank.debit(it_session->second, amount);
-            if (result == "ok") {
-                res.setJson(makeJsonResponse(true, "Debit successful"));
-            } else {
-                res.setJson(makeJsonResponse(false, result));
-            }
-        } catch (...) {
-            res.setJson(makeJsonResponse(false, "Invalid amount"));
+        Banking::Money amount;
+        if (!Banking::Money::parse(it_amount->second, amount)) {
+            writeJsonResponse(res, false, "Invalid amount");
+            return;
+        }
+        
+        std::string result = bank.debit(it_session->second, amount);
+        if (result == "ok") {
+            writeJsonResponse(res, true, "Debit successful");
+        } else {
+            writeJsonResponse(res, false, result);
         }
     });
     
@@ -756,20 +861,21 @@ int main(int argc, char* argv[]) {
         auto it_amount = req.queryParams.find("amount");
         
         if (it_session == req.queryParams.end() || it_to == req.queryParams.end() || it_amount == req.queryParams.end()) {
-            res.setJson(makeJsonResponse(false, "Missing session_id, to_account, or amount"));
+            writeJsonResponse(res, false, "Missing session_id, to_account, or amount");
             return;
         }
         
-        try {
-            double amount = std::stod(it_amount->second);
-            std::string result = bank.transfer(it_session->second, it_to->second, amount);
-            if (result == "ok") {
-                res.setJson(makeJsonResponse(true, "Transfer successful"));
-            } else {
-                res.setJson(makeJsonResponse(false, result));
-            }
-        } catch (...) {
-            res.setJson(makeJsonResponse(false, "Invalid amount"));
+        Banking::Money amount;
+        if (!Banking::Money::parse(it_amount->second, amount)) {
+            writeJsonResponse(res, false, "Invalid amount");
+            return;
+        }
+        
+        std::string result = bank.transfer(it_session->second, it_to->second, amount);
+        if (result == "ok") {
+            writeJsonResponse(res, true, "Transfer successful");
+        } else {
+            writeJsonResponse(res, false, result);
         }
     });
     
@@ -777,7 +883,7 @@ int main(int argc, char* argv[]) {
         auto it_session = req.queryParams.find("session_id");
         
         if (it_session == req.queryParams.end()) {
-            res.setJson(makeJsonResponse(false, "Missing session_id"));
+            writeJsonResponse(res, false, "Missing session_id");
             return;
         }
         
@@ -791,9 +897,41 @@ int main(int argc, char* argv[]) {
         
         std::string result = bank.getStatement(it_session->second, lines);
         if (result.substr(0, 5) == "error") {
-            res.setJson(makeJsonResponse(false, result));
+            writeJsonResponse(res, false, result);
+        } else {
+            writeJsonResponse(res, true, "Statement retrieved", result);
+        }
+    });
+    
+    // Typed statement page; "next" is the before= cursor for older transactions
+    server.addRoute("GET", "/api/transactions", [&bank](const Banking::HttpRequest& req, Banking::HttpResponse& res) {
+        auto it_session = req.queryParams.find("session_id");
+        
+        if (it_session == req.queryParams.end()) {
+            writeJsonResponse(res, false, "Missing session_id");
+            return;
+        }
+        
+        uint64_t before = UINT64_MAX;
+        if (!req.queryNumber("before", before)) {
+            res.setBadRequest("before must be a sequence number");
+            return;
+        }
+        
+        uint64_t limit = Banking::STATEMENT_PAGE_SIZE;
+        if (!req.queryNumber("limit", limit)) {
+            res.setBadRequest("limit must be a number");
+            return;
+        }
+        
+        std::vector<Banking::Transaction> transactions;
+        uint64_t next = 0;
+        std::string result = bank.getTransactions(it_session->second, transactions, next, before,
+                                                  static_cast<size_t>(std::min<uint64_t>(limit, SIZE_MAX)));
+        if (result == "ok") {
+            writeTransactionsResponse(res, transactions, next);
         } else {
-            res.setJson(makeJsonResponse(true, "Statement retrieved", result));
+            writeJsonResponse(res, false, result);
         }
     });
     
@@ -803,15 +941,15 @@ int main(int argc, char* argv[]) {
         auto it_pin = req.queryParams.find("pin");
         
         if (it_session == req.queryParams.end() || it_account == req.queryParams.end() || it_pin == req.queryParams.end()) {
-            res.setJson(makeJsonResponse(false, "Missing session_id, account, or pin"));
+            writeJsonResponse(res, false, "Missing session_id, account, or pin");
             return;
         }
         
         std::string result = bank.createAccount(it_session->second, it_account->second, it_pin->second);
         if (result == "ok") {
-            res.setJson(makeJsonResponse(true, "Account created"));
+            writeJsonResponse(res, true, "Account created");
         } else {
-            res.setJson(makeJsonResponse(false, result));
+            writeJsonResponse(res, false, result);
         }
     });
     
@@ -819,26 +957,94 @@ int main(int argc, char* argv[]) {
         auto it_session = req.queryParams.find("session_id");
         
         if (it_session == req.queryParams.end()) {
-            res.setJson(makeJsonResponse(false, "Missing session_id"));
+            writeJsonResponse(res, false, "Missing session_id");
             return;
         }
         
-        std::string result = bank.listAccounts(it_session->second);
+        std::string after;
+        auto it_after = req.queryParams.find("after");
+        if (it_after != req.queryParams.end()) {
+            after = it_after->second;
+        }
+        
+        uint64_t limit = Banking::ACCOUNTS_PAGE_SIZE;
+        if (!req.queryNumber("limit", limit)) {
+            res.setBadRequest("limit must be a number");
+            return;
+        }
+        
+        std::string result = bank.listAccounts(it_session->second, after,
+                                               static_cast<size_t>(std::min<uint64_t>(limit, SIZE_MAX)));
         if (result.substr(0, 5) == "error") {
-            res.setJson(makeJsonResponse(false, result));
+            writeJsonResponse(res, false, result);
         } else {
-            res.setJson(makeJsonResponse(true, "Accounts listed", result));
+            writeJsonResponse(res, true, "Accounts listed", result);
         }
     });
     
-    // Static file handler
+    server.addRoute("GET", "/api/session_stats", [&bank](const Banking::HttpRequest& req, Banking::HttpResponse& res) {
+        auto it_session = req.queryParams.find("session_id");
+        
+        if (it_session == req.queryParams.end()) {
+            writeJsonResponse(res, false, "Missing session_id");
+            return;
+        }
+        
+        std::string result = bank.getSessionStats(it_session->second);
+        if (result.substr(0, 5) == "error") {
+            writeJsonResponse(res, false, result);
+        } else {
+            writeJsonResponse(res, true, "Session stats", result);
+        }
+    });
+    
+    // Body: one operation per line (see parseBatchOperation); a malformed
+    // line rejects the whole batch before anything is applied
+    server.addRoute("POST", "/api/batch", [&bank](const Banking::HttpRequest& req, Banking::HttpResponse& res) {
+        auto it_session = req.queryParams.find("session_id");
+        
+        if (it_session == req.queryParams.end()) {
+            writeJsonResponse(res, false, "Missing session_id");
+            return;
+        }
+        
+        std::vector<Banking::BatchOperation> operations;
+        std::istringstream body{std::string(req.body)};
+        std::string line;
+        size_t lineNumber = 0;
+        while (std::getline(body, line)) {
+            ++lineNumber;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty()) {
+                continue;
+            }
+            
+            Banking::BatchOperation operation;
+            if (!parseBatchOperation(line, operation)) {
+                writeJsonResponse(res, false, "Invalid operation on line " + std::to_string(lineNumber));
+                return;
+            }
+            operations.push_back(std::move(operation));
+        }
+        
+        std::vector<std::string> results;
+        std::string result = bank.applyBatch(it_session->second, operations, results);
+        writeBatchResponse(res, result, results);
+    });
+    
+    // Static files, compressed once here and served from memory
+    static const Banking::StaticAsset indexPage("text/html; charset=utf-8", getHtmlContent());
+    static const Banking::StaticAsset styleSheet("text/css; charset=utf-8", getCssContent());
+    static const Banking::StaticAsset script("application/javascript; charset=utf-8", getJsContent());
     server.setStaticHandler([](const Banking::HttpRequest& req, Banking::HttpResponse& res) {
         if (req.path == "/" || req.path == "/index.html") {
-            res.setHtml(getHtmlContent());
+            indexPage.serve(req, res);
         } else if (req.path == "/style.css") {
-            res.setCss(getCssContent());
+            styleSheet.serve(req, res);
         } else if (req.path == "/app.js") {
-            res.setJs(getJsContent());
+            script.serve(req, res);
         } else {
             res.setNotFound();
         }
@@ -854,10 +1060,12 @@ int main(int argc, char* argv[]) {
     std::cout << "Open http://localhost:" << port << " in your browser.\n";
     std::cout << "Press Ctrl+C to stop.\n";
     
-    // Keep running until stopped
-    while (server.isRunning()) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+    // Keep running until a signal asks to stop
+    while (server.isRunning() && !g_stopRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
+    std::cout << "\nShutting down server...\n";
+    server.stop();
     
     return 0;
 }
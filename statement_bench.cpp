@@ -0,0 +1,105 @@
+// Microbenchmark: cost of reading the last N lines of a long statement.
+// Compares the original read-everything approach of Bank::getStatement with
+// StatementFile::tail on statement.csv and on the binary statement.bin.
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "StatementFile.h"
+
+namespace fs = std::filesystem;
+
+namespace legacy {
+
+// What getStatement did before the tail reader
+std::vector<std::string> tail(const std::string& path, size_t count) {
+    std::ifstream file(path);
+    std::vector<std::string> allLines;
+    std::string line;
+    while (std::getline(file, line)) {
+        allLines.push_back(line);
+    }
+    size_t start = allLines.size() > count ? allLines.size() - count : 0;
+    return std::vector<std::string>(allLines.begin() + static_cast<std::ptrdiff_t>(start), allLines.end());
+}
+
+} // namespace legacy
+
+namespace {
+
+void writeStatement(const std::string& path, size_t rows) {
+    std::ofstream file(path, std::ios::trunc);
+    file << "2026-01-01 00:00:00,ACCOUNT_CREATED,0.00,0.00\n";
+    long balanceCents = 0;
+    for (size_t i = 1; i < rows; ++i) {
+        long amountCents = static_cast<long>(i % 9000) + 100;
+        const char* type = "DEPOSIT";
+        if (i % 3 == 0 && balanceCents >= amountCents) {
+            type = "DEBIT";
+            balanceCents -= amountCents;
+        } else {
+            balanceCents += amountCents;
+        }
+        char line[96];
+        int seconds = static_cast<int>(i % 60);
+        int minutes = static_cast<int>(i / 60 % 60);
+        int hours = static_cast<int>(i / 3600 % 24);
+        std::snprintf(line, sizeof(line), "2026-01-01 %02d:%02d:%02d,%s,%ld.%02ld,%ld.%02ld\n",
+                      hours, minutes, seconds, type, amountCents / 100, amountCents % 100,
+                      balanceCents / 100, balanceCents % 100);
+        file << line;
+    }
+}
+
+template <typename Fn>
+double microsPerCall(int iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t rows = 1000000;
+    if (argc > 1) {
+        rows = static_cast<size_t>(std::atol(argv[1]));
+    }
+
+    fs::path dir = fs::temp_directory_path() / "statement_bench";
+    fs::create_directories(dir);
+    std::string csvPath = (dir / "statement.csv").string();
+    std::string binPath = (dir / "statement.bin").string();
+    writeStatement(csvPath, rows);
+    Banking::convertStatement(csvPath, Banking::StatementFormat::Csv, binPath, Banking::StatementFormat::Binary);
+    std::cout << rows << " rows: statement.csv " << fs::file_size(csvPath) / 1024 << " KiB, statement.bin "
+              << fs::file_size(binPath) / 1024 << " KiB\n\n";
+
+    Banking::StatementFile csv(csvPath, Banking::StatementFormat::Csv);
+    Banking::StatementFile binary(binPath, Banking::StatementFormat::Binary);
+
+    size_t sink = 0;
+    std::cout << "lines   legacy us/call   csv tail us/call   binary tail us/call\n";
+    for (size_t lines : {10, 100, 1000}) {
+        double before = microsPerCall(3, [&] { sink += legacy::tail(csvPath, lines).size(); });
+        double csvTail = microsPerCall(2000, [&] { sink += csv.tail(lines).size(); });
+        double binaryTail = microsPerCall(2000, [&] { sink += binary.tail(lines).size(); });
+
+        std::cout.width(8);
+        std::cout << std::left << lines;
+        std::cout.width(17);
+        std::cout << static_cast<long>(before);
+        std::cout.width(19);
+        std::cout << csvTail;
+        std::cout << binaryTail << "\n";
+    }
+
+    fs::remove_all(dir);
+    return sink == 0 ? 1 : 0;
+}